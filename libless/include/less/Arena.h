@@ -0,0 +1,84 @@
+#ifndef __less_Arena_h__
+#define __less_Arena_h__
+
+#include <cstddef>
+
+/**
+ * Region allocator for the objects of a single compilation.
+ *
+ * Memory is handed out from large blocks by bumping a pointer and is
+ * only returned to the system when the arena is destroyed, which frees
+ * all blocks at once. Objects deriving from ArenaObject are allocated
+ * from the arena that is current on the creating thread (see
+ * Arena::Scope) and fall back to the global heap when there is none.
+ *
+ * The arena has to outlive every object allocated from it.
+ */
+class Arena {
+private:
+  struct Block {
+    Block* next;
+  };
+
+  Block* blocks;
+  char* pos;
+  char* end;
+  size_t blockSize;
+  size_t allocated;
+
+  static thread_local Arena* current;
+
+  void* allocateBlock(size_t size);
+
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+
+public:
+  static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+  ~Arena();
+
+  /**
+   * Allocate size bytes, aligned for any type.
+   */
+  void* allocate(size_t size);
+
+  /**
+   * Total number of bytes handed out by allocate().
+   */
+  size_t getAllocated() const;
+
+  /**
+   * The arena ArenaObjects are allocated from on this thread, or NULL.
+   */
+  static Arena* getCurrent();
+
+  /**
+   * Makes an arena current on this thread for the lifetime of the
+   * scope and restores the previous one afterwards.
+   */
+  class Scope {
+  private:
+    Arena* previous;
+
+  public:
+    Scope(Arena& arena);
+    ~Scope();
+  };
+};
+
+/**
+ * Base class for objects that are allocated from the current Arena.
+ *
+ * Deleting an object runs its destructor as usual, including the
+ * destructors of the objects it deletes in turn, but leaves the memory
+ * to the arena.
+ */
+class ArenaObject {
+public:
+  static void* operator new(size_t size);
+  static void operator delete(void* p);
+};
+
+#endif  // __less_Arena_h__
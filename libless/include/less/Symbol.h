@@ -0,0 +1,73 @@
+#ifndef __less_Symbol_h__
+#define __less_Symbol_h__
+
+#include <cstddef>
+#include <string>
+
+/**
+ * An interned name, like a variable or function name.
+ *
+ * Each distinct string is stored once in a SymbolTable and gets a stable
+ * integer id, so symbols are compared and ordered by id instead of
+ * character by character. A symbol is valid as long as the table it was
+ * interned in.
+ *
+ * A default constructed symbol is the null symbol; it is not equal to
+ * any interned string.
+ */
+class Symbol {
+public:
+  struct Entry {
+    std::string str;
+    unsigned int id;
+  };
+
+  Symbol() : entry(NULL) {
+  }
+
+  /**
+   * Intern str, adding it to the current table if it is not in it or in
+   * the global table yet.
+   */
+  explicit Symbol(const std::string &str);
+
+  /**
+   * Look up str without adding it to the table.
+   *
+   * @return the symbol of str in the current or the global table, or
+   *         the null symbol if str was never interned there; a map of
+   *         symbols can not contain it then.
+   */
+  static Symbol find(const std::string &str);
+
+  bool isNull() const {
+    return entry == NULL;
+  }
+
+  /**
+   * The id of the symbol, 0 for the null symbol.
+   */
+  unsigned int getId() const {
+    return (entry == NULL) ? 0 : entry->id;
+  }
+
+  const std::string &getString() const;
+
+  inline bool operator==(const Symbol &s) const {
+    return entry == s.entry;
+  }
+  inline bool operator!=(const Symbol &s) const {
+    return entry != s.entry;
+  }
+  inline bool operator<(const Symbol &s) const {
+    return getId() < s.getId();
+  }
+
+private:
+  const Entry *entry;
+
+  Symbol(const Entry *entry) : entry(entry) {
+  }
+};
+
+#endif  // __less_Symbol_h__
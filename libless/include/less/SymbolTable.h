@@ -0,0 +1,90 @@
+#ifndef __less_SymbolTable_h__
+#define __less_SymbolTable_h__
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "less/Symbol.h"
+
+/**
+ * The interned strings of a compilation, or of the compilations that
+ * share an ImportCache. Symbols are interned in the table that is
+ * current on the creating thread (see SymbolTable::Scope) and are only
+ * valid as long as that table exists.
+ *
+ * Names that are interned without a current table, like the names of
+ * the built in functions, go to the global table, which lives as long
+ * as the process. Names in the global table are found from every
+ * table, so a table only holds the names of its own sources.
+ *
+ * The table is safe to use from several threads.
+ */
+class SymbolTable {
+public:
+  SymbolTable();
+  ~SymbolTable();
+
+  /**
+   * The number of strings in the table.
+   */
+  size_t size() const;
+
+  /**
+   * The table symbols are interned in on this thread, or NULL.
+   */
+  static SymbolTable* getCurrent();
+
+  static SymbolTable& getGlobal();
+
+  /**
+   * Makes a table current on this thread for the lifetime of the scope
+   * and restores the previous one afterwards.
+   */
+  class Scope {
+  private:
+    SymbolTable* previous;
+
+  public:
+    Scope(SymbolTable& table);
+    ~Scope();
+  };
+
+private:
+  /**
+   * The table is split in shards with their own lock, so threads that
+   * intern different names rarely wait for each other.
+   */
+  static const size_t SHARDS = 16;
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, Symbol::Entry*> entries;
+  };
+
+  Shard shards[SHARDS];
+  std::atomic<size_t> count;
+
+  static thread_local SymbolTable* current;
+
+  Shard& getShard(const std::string& str);
+
+  /**
+   * The entry of str, or NULL if it is not in this table.
+   */
+  const Symbol::Entry* find(const std::string& str);
+
+  /**
+   * The entry of str, adding it to this table if it is not in it yet.
+   */
+  const Symbol::Entry* intern(const std::string& str);
+
+  SymbolTable(const SymbolTable&);
+  SymbolTable& operator=(const SymbolTable&);
+
+  friend class Symbol;
+};
+
+#endif  // __less_SymbolTable_h__
@@ -2,6 +2,7 @@
 #define __less_Token_h__
 
 #include <string>
+#include "less/Symbol.h"
 
 class Token : public std::string {
 protected:
@@ -36,7 +37,7 @@ public:
   } type;
   //  std::string str;
 
-  static char BUILTIN_SOURCE[8];
+  static const char BUILTIN_SOURCE[8];
   static const Token BUILTIN_SPACE, BUILTIN_COMMA, BUILTIN_PAREN_OPEN,
     BUILTIN_PAREN_CLOSED, BUILTIN_IMPORTANT;
 
@@ -82,12 +83,35 @@ public:
    */
   std::string getUrlString() const;
 
+  /**
+   * The symbol of the token. The tokenizer sets it for @-keywords and
+   * function names; it is the null symbol for other tokens and for
+   * tokens that were changed since. Changes made through the
+   * std::string interface keep the symbol.
+   */
+  inline const Symbol &getSymbol() const {
+    return symbol;
+  }
+  inline void setSymbol(const Symbol &symbol) {
+    this->symbol = symbol;
+  }
+
   inline std::string &append(char c) {
+    symbol = Symbol();
     return std::string::append(1, c);
   }
   inline std::string &append(const std::string &c) {
+    symbol = Symbol();
     return std::string::append(c);
   }
+  inline std::string &append(const char *s, size_t n) {
+    symbol = Symbol();
+    return std::string::append(s, n);
+  }
+  inline std::string &assign(const std::string &str) {
+    symbol = Symbol();
+    return std::string::assign(str);
+  }
 
   inline bool operator==(const Token &t) const {
     return (type == t.type && (std::string) * this == (std::string)t);
@@ -112,9 +136,13 @@ public:
   }
 
   inline Token &operator=(const std::string &str) {
+    symbol = Symbol();
     std::string::assign(str);
     return *this;
   }
+
+private:
+  Symbol symbol;
 };
 
 #endif  // __less_Token_h__
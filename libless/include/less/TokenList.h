@@ -1,13 +1,43 @@
 #ifndef __less_TokenList_h__
 #define __less_TokenList_h__
 
-#include <list>
+#include <vector>
 #include "less/Token.h"
 
-class TokenList : public std::list<Token> {
+/**
+ * A sequence of tokens, stored contiguously.
+ *
+ * Most lists are short declaration values of one to a few tokens, so
+ * the first push_back() reserves room for INITIAL_CAPACITY tokens and
+ * those values cost a single allocation.
+ *
+ * Iterators are invalidated by insertions and erasures, and removing
+ * tokens from the front is linear in the length of the list.
+ */
+class TokenList : public std::vector<Token> {
 public:
+  static const size_t INITIAL_CAPACITY = 4;
+
   virtual ~TokenList();
 
+  void push_back(const Token &t) {
+    if (capacity() == 0)
+      reserve(INITIAL_CAPACITY);
+    std::vector<Token>::push_back(t);
+  }
+  void push_back(Token &&t) {
+    if (capacity() == 0)
+      reserve(INITIAL_CAPACITY);
+    std::vector<Token>::push_back(std::move(t));
+  }
+
+  void push_front(const Token &t) {
+    insert(begin(), t);
+  }
+  void pop_front() {
+    erase(begin());
+  }
+
   /**
    * Trim whitespace tokens from the front of the selector.
    */
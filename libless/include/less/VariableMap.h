@@ -1,17 +1,101 @@
 #ifndef __less_VariableMap_h__
 #define __less_VariableMap_h__
 
-#include <map>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+#include "less/Symbol.h"
 #include "less/TokenList.h"
 
-class VariableMap : public std::map<std::string, TokenList> {
+/**
+ * Variable values by interned variable name.
+ *
+ * The entries are kept in insertion order in a list, so pointers to the
+ * values stay valid while variables are added, and iteration visits the
+ * variables in the order they were added. Most scopes define a few
+ * variables and are searched in order; larger maps look the values up
+ * in an open addressing hash table on the id of the symbol, with linear
+ * probing.
+ */
+class VariableMap {
 public:
+  typedef std::pair<const Symbol, TokenList> value_type;
+  typedef std::list<value_type>::iterator iterator;
+  typedef std::list<value_type>::const_iterator const_iterator;
+
+  VariableMap();
+  VariableMap(const VariableMap &map);
+  VariableMap &operator=(const VariableMap &map);
+
+  iterator begin() {
+    return entries.begin();
+  }
+  iterator end() {
+    return entries.end();
+  }
+  const_iterator begin() const {
+    return entries.begin();
+  }
+  const_iterator end() const {
+    return entries.end();
+  }
+  size_t size() const {
+    return entries.size();
+  }
+  bool empty() const {
+    return entries.empty();
+  }
+
+  /**
+   * The value of key, which is added with an empty value if the map
+   * does not contain it.
+   */
+  TokenList &operator[](const Symbol &key);
+
+  /**
+   * Add value if the map does not contain its key yet.
+   *
+   * @return the entry of the key, and true if value was added.
+   */
+  std::pair<iterator, bool> insert(const value_type &value);
+  std::pair<iterator, bool> insert(const Symbol &key, const TokenList &value);
+
+  void clear();
+
+  iterator find(const Symbol &key);
+  const_iterator find(const Symbol &key) const;
+
+  const TokenList *getVariable(const Symbol &key) const;
   const TokenList *getVariable(const std::string &key) const;
   void merge(const VariableMap &map);
 
   void overwrite(const VariableMap &map);
 
   std::string toString() const;
+
+private:
+  struct Slot {
+    // the id of the symbol, 0 if the slot is empty
+    unsigned int id;
+    iterator entry;
+  };
+
+  std::list<value_type> entries;
+  // empty while the map is small, then a power of two
+  std::vector<Slot> slots;
+
+  /**
+   * The slot that holds id, or the empty slot where it would go. The
+   * table must not be empty.
+   */
+  size_t findSlot(unsigned int id) const;
+  void rehash(size_t capacity);
+  /**
+   * Add key with an empty value; the map must not contain it.
+   */
+  iterator add(const Symbol &key);
 };
 
 #endif  // __less_VariableMap_h__
@@ -0,0 +1,58 @@
+#ifndef __less_css_CharScanner_h__
+#define __less_css_CharScanner_h__
+
+#include <cstddef>
+
+/**
+ * Finds the end of a run of characters in a block of input many bytes
+ * at a time. The CssTokenizer uses it for the long runs that make up
+ * most of a stylesheet: whitespace, comments and strings.
+ *
+ * The SSE2 or AVX2 implementation is picked when the first block is
+ * scanned, depending on what the processor supports. Other processors
+ * use a scalar implementation that gives the same results.
+ */
+class CharScanner {
+public:
+  enum Implementation { SCALAR, SSE2, AVX2 };
+
+  /**
+   * The maximum number of characters that findAny() looks for.
+   */
+  static const size_t MAX_CHARS = 8;
+
+  /**
+   * @return the first character in [p, end) that is one of the n
+   *         characters in chars, or end.
+   */
+  static const char* findAny(const char* p,
+                             const char* end,
+                             const char* chars,
+                             size_t n);
+
+  /**
+   * @return the first character in [p, end) that is not whitespace, or
+   *         end.
+   */
+  static const char* findNotWhitespace(const char* p, const char* end);
+
+  /**
+   * Count the newlines ('\n') in [p, end).
+   *
+   * @param last set to the last newline, or NULL if there is none.
+   */
+  static size_t countNewlines(const char* p,
+                              const char* end,
+                              const char** last);
+
+  static Implementation getImplementation();
+
+  /**
+   * Use the given implementation instead of the one that was picked.
+   *
+   * @return false if the processor does not support it.
+   */
+  static bool setImplementation(Implementation implementation);
+};
+
+#endif  // __less_css_CharScanner_h__
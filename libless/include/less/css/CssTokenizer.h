@@ -4,7 +4,9 @@
 #include <iostream>
 #include <string>
 #include "less/Token.h"
+#include "less/css/CharScanner.h"
 #include "less/css/IOException.h"
+#include "less/css/InputSource.h"
 #include "less/css/ParseException.h"
 
 using namespace std;
@@ -84,11 +86,20 @@ using namespace std;
  */
 class CssTokenizer {
 public:
+  /**
+   * Tokenize the input stream. The stream is read in chunks.
+   */
   CssTokenizer(istream& in, const char* source);
 
-  ~CssTokenizer();
+  /**
+   * Tokenize the characters of an InputSource. The source has to stay
+   * valid for the lifetime of the tokenizer.
+   */
+  CssTokenizer(InputSource& in, const char* source);
 
-  Token::Type readNextToken();
+  virtual ~CssTokenizer();
+
+  virtual Token::Type readNextToken();
 
   Token& getToken();
   Token::Type getTokenType();
@@ -96,7 +107,32 @@ public:
   const char* getSource();
 
 protected:
-  istream* in;
+  /**
+   * For subclasses that produce tokens without reading characters.
+   */
+  CssTokenizer(const char* source);
+
+  /**
+   * The input source, or NULL once the end of the input is reached.
+   */
+  InputSource* in;
+  StreamInputSource* streamInput;
+
+  /**
+   * The part of the current input block that has not been read yet.
+   */
+  const char* pos;
+  const char* end;
+
+  /**
+   * Start of the characters of the current token that have not been
+   * copied to currentToken yet, or NULL outside of a token.
+   *
+   * Characters are not copied one at a time; the token is copied
+   * from the input block in one go when it is complete or when the
+   * block is replaced.
+   */
+  const char* tokenStart;
 
   Token currentToken;
   char lastRead;
@@ -105,6 +141,25 @@ protected:
   const char* source;
 
   void readChar();
+  bool readBuffer();
+
+  /**
+   * Copy the characters read since the last update to currentToken.
+   */
+  void updateToken();
+
+  /**
+   * Read the characters up to q, a position in the current block after
+   * pos, in one go: lastRead becomes the character before q and the
+   * line and column are updated as if readChar() was called for each
+   * character. The characters must not contain the escape character.
+   */
+  void skipTo(const char* q);
+
+  /**
+   * Read a run of whitespace.
+   */
+  void skipWhitespace();
 
   bool readIdent();
   bool readName();
@@ -113,6 +168,7 @@ protected:
   bool readEscape();
   bool readUnicode();
   bool readNMChar();
+  void readNMChars();
   bool readNum(bool readDecimals);
   bool readNumSuffix();
   bool readString();
@@ -122,10 +178,41 @@ protected:
   virtual bool readComment();
   bool readUnicodeRange();
 
+  /**
+   * @param classes a combination of the character classes in
+   *        CssTokenizer.cpp.
+   */
+  bool lastReadIs(unsigned int classes);
   bool lastReadEq(char c);
   bool lastReadInRange(char c1, char c2);
   bool lastReadIsDigit();
   bool lastReadIsHex();
 };
 
+inline void CssTokenizer::readChar() {
+  if (in == NULL)
+    return;
+
+  // Last char was a newline. Increment the line counter.
+  if (lastRead == '\n') {
+    line++;
+    column = 0;
+  } else
+    column++;
+
+  if (pos == end && !readBuffer()) {
+    in = NULL;
+    return;
+  }
+  lastRead = *pos++;
+
+  // check for escape key
+  if (lastRead == 27) {
+    // leave the escape character out of the current token
+    pos--;
+    in = NULL;
+  } else if (lastRead == '\n' && column > 0)  // don't count newlines as chars
+    column--;
+}
+
 #endif  // __less_css_CssTokenizer_h__
@@ -45,6 +45,12 @@ public:
   virtual void writeMediaQueryEnd();
 
   void writeSourceMapUrl(const char *sourcemap_url);
+
+  /**
+   * Write css that was written by a writer of the same kind before.
+   * column is the column the writer is at after the css.
+   */
+  void writeCss(const std::string &css, unsigned int column);
 };
 
 #endif  // __less_css_CssWriter_h__
@@ -0,0 +1,110 @@
+#ifndef __less_css_InputSource_h__
+#define __less_css_InputSource_h__
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "less/css/IOException.h"
+
+using namespace std;
+
+/**
+ * A block of input characters for the CssTokenizer.
+ *
+ * The tokenizer scans the characters between getBegin() and getEnd()
+ * by pointer and calls fill() once it reaches the end. Implementations
+ * decide how much input is made available per call: a memory buffer
+ * or a mapped file is available in one block, a stream is read in
+ * chunks.
+ */
+class InputSource {
+protected:
+  const char* begin;
+  const char* end;
+
+public:
+  InputSource() : begin(NULL), end(NULL) {
+  }
+  virtual ~InputSource() {
+  }
+
+  /**
+   * Make the next block of input available.
+   *
+   * @return false if there is no more input.
+   * @throws IOException if the input could not be read.
+   */
+  virtual bool fill() = 0;
+
+  const char* getBegin() const {
+    return begin;
+  }
+  const char* getEnd() const {
+    return end;
+  }
+};
+
+/**
+ * Input from a block of memory. The memory is not copied and has to
+ * stay valid for the lifetime of the source.
+ */
+class BufferInputSource : public InputSource {
+private:
+  const char* data;
+  size_t length;
+  bool filled;
+
+public:
+  BufferInputSource(const char* data, size_t length);
+  BufferInputSource(const std::string& data);
+
+  virtual bool fill();
+};
+
+/**
+ * Input read from an istream in chunks.
+ *
+ * Each fill() blocks for a single character and then takes whatever
+ * the stream has buffered, so interactive input is still tokenized
+ * line by line.
+ */
+class StreamInputSource : public InputSource {
+private:
+  istream* in;
+  char* buffer;
+  size_t size;
+
+public:
+  static const size_t DEFAULT_BUFFER_SIZE = 8192;
+
+  StreamInputSource(istream& in, size_t size = DEFAULT_BUFFER_SIZE);
+  virtual ~StreamInputSource();
+
+  virtual bool fill();
+};
+
+/**
+ * Input from a file on disk. The file is mapped into memory when
+ * possible and read in one go otherwise.
+ */
+class FileInputSource : public InputSource {
+private:
+  void* map;
+  size_t mapLength;
+  std::string contents;
+  bool filled;
+
+  void read(int fd);
+
+public:
+  /**
+   * @throws IOException if the file can not be opened.
+   */
+  FileInputSource(const char* filename);
+  virtual ~FileInputSource();
+
+  virtual bool fill();
+};
+
+#endif  // __less_css_InputSource_h__
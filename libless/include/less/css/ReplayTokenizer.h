@@ -0,0 +1,33 @@
+#ifndef __less_css_ReplayTokenizer_h__
+#define __less_css_ReplayTokenizer_h__
+
+#include "less/TokenList.h"
+#include "less/css/CssTokenizer.h"
+
+/**
+ * Returns the tokens of a list that was produced by another tokenizer,
+ * as if they were read from the input again. The tokens get the source
+ * of this tokenizer, their line and column are kept.
+ *
+ * The list has to stay valid and unchanged for the lifetime of the
+ * tokenizer.
+ */
+class ReplayTokenizer : public CssTokenizer {
+public:
+  ReplayTokenizer(const TokenList& tokens, const char* source);
+  /**
+   * Returns the tokens in [begin, end) of a list.
+   */
+  ReplayTokenizer(TokenList::const_iterator begin,
+                  TokenList::const_iterator end,
+                  const char* source);
+  virtual ~ReplayTokenizer();
+
+  virtual Token::Type readNextToken();
+
+private:
+  TokenList::const_iterator it;
+  TokenList::const_iterator tokensEnd;
+};
+
+#endif  // __less_css_ReplayTokenizer_h__
@@ -0,0 +1,91 @@
+#ifndef __less_less_ImportCache_h__
+#define __less_less_ImportCache_h__
+
+#include <sys/stat.h>
+#include <ctime>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "less/SymbolTable.h"
+#include "less/TokenList.h"
+#include "less/css/IOException.h"
+
+/**
+ * Keeps imported files in memory, both as text and as tokens, so a file
+ * that is imported more than once is only read and tokenized once.
+ * Files are identified by their resolved, absolute path.
+ *
+ * A cached entry is used as long as the modification time and size of
+ * the file are unchanged. Otherwise the file is read again; if the
+ * contents hash to the same value the entry is kept as it was.
+ *
+ * The cache can be shared by compilations on different threads.
+ * Entries are immutable; a file that changes gets a new entry and
+ * compilations that still hold the old one are not affected. A thread
+ * asking for a file that another thread is reading waits for that
+ * thread instead of reading the file again.
+ *
+ * The names in the tokens are interned in the symbol table of the
+ * cache, which has to be current while the tokens are parsed and
+ * processed. Clearing the cache starts a new table.
+ */
+class ImportCache {
+public:
+  struct Entry {
+    std::string path;
+    unsigned long long hash;
+    std::string contents;
+
+    /**
+     * The tokens of the contents, as returned by a LessTokenizer, up to
+     * but not including the end of input. Only valid if tokenized is
+     * true; files that fail to tokenize have to be parsed from the
+     * contents so errors are reported where the parser finds them.
+     */
+    TokenList tokens;
+    bool tokenized;
+
+    // the table the symbols of the tokens are interned in.
+    std::shared_ptr<SymbolTable> symbols;
+  };
+
+  ImportCache();
+
+  /**
+   * Returns the entry for the file, reading it if it is not cached or
+   * has changed on disk.
+   *
+   * @throws IOException if the file can not be read.
+   */
+  std::shared_ptr<const Entry> get(const std::string& filename);
+
+  void clear();
+  size_t size() const;
+
+  std::shared_ptr<SymbolTable> getSymbols() const;
+
+  static unsigned long long hash(const std::string& contents);
+
+private:
+  struct File {
+    struct timespec mtime;
+    off_t size;
+    std::shared_ptr<const Entry> entry;
+  };
+  std::map<std::string, File> files;
+  std::shared_ptr<SymbolTable> symbols;
+  mutable std::mutex mutex;
+
+  // files that are being read by a thread
+  std::set<std::string> loading;
+  std::condition_variable loaded;
+
+  void read(const std::string& filename, std::string& contents);
+  void tokenize(Entry& entry);
+};
+
+#endif  // __less_less_ImportCache_h__
@@ -0,0 +1,69 @@
+#ifndef __less_less_ImportPrefetcher_h__
+#define __less_less_ImportPrefetcher_h__
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "less/less/ImportCache.h"
+
+/**
+ * Loads the files a stylesheet imports into an ImportCache before the
+ * parser asks for them.
+ *
+ * The tokens of a file are scanned for @import statements, which are
+ * resolved the way LessParser resolves them. Each file that is found is
+ * read and tokenized by a task given to the executor, and its own
+ * imports are scanned in turn. The parser still imports the files one
+ * by one in the order of the statements; it finds them in the cache or,
+ * if a task is still reading a file, waits for that task.
+ *
+ * The scan does not evaluate the stylesheet, so it can load files that
+ * are not imported in the end, for example imports in mixins that are
+ * never called. Files that can not be read are skipped; the parser
+ * reports the error when it gets to the import.
+ */
+class ImportPrefetcher {
+public:
+  typedef std::function<void(const std::function<void()> &)> Executor;
+
+  /**
+   * @param includePaths the include paths given to the parser. The list
+   *        has to stay valid for the lifetime of the prefetcher.
+   * @param executor runs a task, normally on another thread.
+   */
+  ImportPrefetcher(ImportCache &cache,
+                   const std::list<const char *> *includePaths,
+                   const Executor &executor);
+
+  /**
+   * Waits for the tasks that were given to the executor, which refer to
+   * the prefetcher.
+   */
+  ~ImportPrefetcher();
+
+  /**
+   * Start loading the files imported by entry. source is the name the
+   * parser uses for the file; imports are resolved relative to it.
+   */
+  void prefetch(const ImportCache::Entry &entry, const char *source);
+
+private:
+  ImportCache &cache;
+  const std::list<const char *> *includePaths;
+  Executor executor;
+
+  std::mutex mutex;
+  // files that have been given to the executor
+  std::set<std::string> seen;
+  // tasks that were given to the executor and have not finished
+  unsigned int running;
+  std::condition_variable finished;
+
+  void fetch(const std::string &filename);
+};
+
+#endif  // __less_less_ImportPrefetcher_h__
@@ -8,7 +8,10 @@
 
 #include "less/css/CssParser.h"
 #include "less/css/CssTokenizer.h"
+#include "less/css/ReplayTokenizer.h"
+#include "less/less/ImportCache.h"
 #include "less/less/LessSelectorParser.h"
+#include "less/lessstylesheet/DependencyGraph.h"
 #include "less/lessstylesheet/LessMediaQuery.h"
 #include "less/lessstylesheet/LessRuleset.h"
 #include "less/lessstylesheet/LessStylesheet.h"
@@ -52,13 +55,35 @@ public:
 
   std::list<const char *> *includePaths;
 
+  /**
+   * If set, imported files are read through the cache instead of from
+   * disk. Imports inherit the cache of the parser that imports them.
+   */
+  ImportCache *importCache;
+
+  /**
+   * If set, the top level statements of the stylesheet and the files
+   * they come from are recorded in the graph. Requires importCache.
+   */
+  DependencyGraph *dependencies;
+
   LessParser(CssTokenizer &tokenizer, std::list<const char *> &source_files)
-      : CssParser(tokenizer), sources(source_files), reference(false) {
+      : CssParser(tokenizer),
+        includePaths(NULL),
+        importCache(NULL),
+        dependencies(NULL),
+        sources(source_files),
+        reference(false) {
   }
   LessParser(CssTokenizer &tokenizer,
              std::list<const char *> &source_files,
              bool isreference)
-      : CssParser(tokenizer), sources(source_files), reference(isreference) {
+      : CssParser(tokenizer),
+        includePaths(NULL),
+        importCache(NULL),
+        dependencies(NULL),
+        sources(source_files),
+        reference(isreference) {
   }
   virtual ~LessParser() {
   }
@@ -70,6 +95,29 @@ public:
    */
   void parseStylesheet(LessRuleset &ruleset);
 
+  /**
+   * @return the IMPORT_* flag for the directive t.
+   * @throws ParseException if t is not a known directive.
+   */
+  static unsigned int parseImportDirective(const Token &t);
+
+  /**
+   * Turn the uri of an import statement into the path of the file to
+   * import, adding a .less extension if the path has none.
+   *
+   * @return false if the file is not imported: remote files, and css
+   *         files unless the less directive is given.
+   */
+  static bool getImportPath(Token &uri, unsigned int directive);
+
+  /**
+   * Find the file uri refers to, relative to the file containing uri
+   * or in one of the include paths.
+   */
+  static bool findFile(const Token &uri,
+                       const std::list<const char *> *includePaths,
+                       std::string &filename);
+
 protected:
   std::list<const char *> &sources;
   bool reference;
@@ -130,8 +178,6 @@ protected:
                             LessStylesheet &stylesheet);
   bool parseImportStatement(TokenList &statement,
                             LessRuleset &ruleset);
-  
-  unsigned int parseImportDirective(Token &t);
 
   bool importFile(Token uri,
                   LessStylesheet &stylesheet,
@@ -147,8 +193,6 @@ private:
 
   std::list<TokenList *> *processArguments(TokenList *arguments);
 
-  bool findFile(Token &uri, std::string &filename);
-
   bool parseRuleset(TokenList &selector,
                     LessStylesheet *stylesheet,
                     LessRuleset *parentRuleset);
@@ -164,6 +208,10 @@ private:
                   LessStylesheet *stylesheet,
                   LessRuleset *ruleset,
                   unsigned int directive);
+  void parseImport(CssTokenizer &tokenizer,
+                   LessStylesheet *stylesheet,
+                   LessRuleset *ruleset,
+                   unsigned int directive);
 };
 
 #endif  // __less_less_LessParser_h__
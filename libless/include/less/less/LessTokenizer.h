@@ -12,6 +12,8 @@
 class LessTokenizer : public CssTokenizer {
 public:
   LessTokenizer(istream& in, const char* source) : CssTokenizer(in, source){};
+  LessTokenizer(InputSource& in, const char* source)
+      : CssTokenizer(in, source){};
   virtual ~LessTokenizer();
 
 protected:
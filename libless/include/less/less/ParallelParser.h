@@ -0,0 +1,80 @@
+#ifndef __less_less_ParallelParser_h__
+#define __less_less_ParallelParser_h__
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "less/Arena.h"
+#include "less/TokenList.h"
+#include "less/lessstylesheet/LessStylesheet.h"
+
+/**
+ * Parses the tokens of a large stylesheet on several threads.
+ *
+ * The tokens are split in chunks at the end of top level statements: a
+ * ';' or a '}' that is not inside a block or parentheses. Each chunk is
+ * parsed by its own LessParser into its own LessStylesheet, and the
+ * statements and variables of the chunks are then moved into the
+ * stylesheet in the order of the chunks. The tokens keep their line and
+ * column, so errors and source maps refer to the original input.
+ *
+ * Stylesheets with @import statements are not split: whether a file is
+ * imported can depend on the files that were imported before it.
+ */
+class ParallelParser {
+public:
+  typedef std::function<void(const std::function<void()> &)> Executor;
+
+  /**
+   * The minimum number of tokens in a chunk.
+   */
+  static const size_t DEFAULT_CHUNK_SIZE = 16384;
+
+  /**
+   * @param executor runs a task, normally on another thread.
+   */
+  ParallelParser(const Executor &executor,
+                 size_t chunkSize = DEFAULT_CHUNK_SIZE);
+  ~ParallelParser();
+
+  /**
+   * Split tokens in chunks of at least chunkSize tokens.
+   *
+   * @param chunks set to the index of the first token of each chunk.
+   * @return false if the tokens are not split, because they contain
+   *         an @import statement or make up a single chunk.
+   */
+  static bool split(const TokenList &tokens,
+                    size_t chunkSize,
+                    std::vector<size_t> &chunks);
+
+  /**
+   * Parse tokens into stylesheet. The chunks are given to the executor,
+   * and the calling thread parses chunks as well until all of them are
+   * done, so it does not wait on tasks that are still queued.
+   *
+   * If the calling thread has a current Arena, the statements are
+   * allocated from arenas of the parser, which has to outlive the
+   * stylesheet then. Names are interned in the SymbolTable of the
+   * calling thread.
+   *
+   * @return false if the tokens were not parsed, because they are not
+   *         split or a chunk has a parse error. The stylesheet is
+   *         unchanged then; parse the tokens with a single LessParser,
+   *         which reports the error.
+   */
+  bool parse(const TokenList &tokens,
+             const char *source,
+             LessStylesheet &stylesheet);
+
+private:
+  Executor executor;
+  size_t chunkSize;
+  std::vector<Arena *> arenas;
+
+  ParallelParser(const ParallelParser &);
+  ParallelParser &operator=(const ParallelParser &);
+};
+
+#endif  // __less_less_ParallelParser_h__
@@ -35,8 +35,13 @@ public:
 
   virtual const LessSelector &getLessSelector() const;
 
-  virtual const TokenList *getVariable(const std::string &key,
+  virtual const TokenList *getVariable(const Symbol &key,
                                        const ProcessingContext &context) const;
+  virtual const TokenList *getLocalVariable(const Symbol &key) const;
+  /**
+   * NULL; a closure continues in the stack it was created in.
+   */
+  virtual const Function *getParentScope() const;
 
   bool isInStack(const LessRuleset &ruleset);
 };
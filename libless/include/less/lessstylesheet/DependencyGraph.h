@@ -0,0 +1,182 @@
+#ifndef __less_lessstylesheet_DependencyGraph_h__
+#define __less_lessstylesheet_DependencyGraph_h__
+
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "less/TokenList.h"
+#include "less/css/CssWriter.h"
+#include "less/less/ImportCache.h"
+
+class LessStylesheet;
+class ProcessingContext;
+class Stylesheet;
+class StylesheetStatement;
+
+/**
+ * The variables and mixins that were looked up while a statement was
+ * processed.
+ */
+struct Dependencies {
+  std::set<std::string> variables;
+  // the class and id selectors in the names of the mixins
+  std::set<std::string> mixins;
+
+  // the statement added variables or mixins to the root scope, which
+  // the statements after it can use.
+  bool sideEffects;
+
+  Dependencies() : sideEffects(false) {
+  }
+
+  /**
+   * Add the variables and the class and id selectors in tokens.
+   *
+   * @return false if tokens contain an interpolated selector; the
+   *         names it defines are only known once it is processed.
+   */
+  bool addNames(const TokenList &tokens);
+};
+
+/**
+ * Records what each top level statement of a stylesheet depends on, so
+ * the next compilation of the stylesheet only has to process the
+ * statements that are affected by a change.
+ *
+ * A statement depends on the file it was parsed from, the files that
+ * were imported into it, and the variables and mixins it looked up
+ * while it was processed. When a file changes, every variable and
+ * class or id selector in the old and the new version of the file is
+ * considered changed. A statement that depends on none of the changed
+ * files and names is not processed again; its css from the previous
+ * compilation is written instead.
+ *
+ * Everything is processed again when the list of imported files
+ * changes or when the stylesheet uses extensions, which can change
+ * any part of the output. Statements that add to the root scope, like
+ * a mixin call in the root, are processed every time.
+ *
+ * A compilation calls begin() before parsing; the parser calls
+ * addFile() and addStatements(), LessStylesheet::process() calls
+ * process() and the compilation ends with write(). The graph only works
+ * with files that are read through an ImportCache.
+ */
+class DependencyGraph {
+public:
+  DependencyGraph();
+
+  /**
+   * Start a compilation of stylesheet. The last compilation that was
+   * written is kept to compare with.
+   */
+  void begin(const LessStylesheet &stylesheet);
+
+  const LessStylesheet *getStylesheet() const;
+
+  /**
+   * Record a file that is parsed, under the name the parser uses for
+   * it.
+   */
+  void addFile(const char *source,
+               const std::shared_ptr<const ImportCache::Entry> &entry);
+
+  /**
+   * Record the statements that were added to stylesheet while a
+   * statement of the file origin was parsed. [imported, end) are the
+   * files that were imported by the statement.
+   */
+  void addStatements(const Stylesheet &stylesheet,
+                     const char *origin,
+                     std::list<const char *>::const_iterator imported,
+                     std::list<const char *>::const_iterator end);
+
+  /**
+   * Process the statements of the stylesheet that are affected by the
+   * changes since the last compilation into css.
+   */
+  void process(Stylesheet &css, ProcessingContext &context);
+
+  /**
+   * Write the css of every statement, processed or kept from the last
+   * compilation, with writer. out has to be the stream of the writer.
+   * The compilation is kept to compare the next one with.
+   */
+  void write(const Stylesheet &css,
+             CssWriter &writer,
+             std::ostringstream &out);
+
+  /**
+   * The number of statements that were not processed again by the
+   * last call to process().
+   */
+  unsigned int getReused() const;
+
+private:
+  struct Node {
+    // the file the statement was parsed from, and the position of the
+    // statement among the top level statements of that file.
+    std::string origin;
+    unsigned int ordinal;
+    // the files that were imported into the statement
+    std::set<std::string> sources;
+    bool reference;
+    Dependencies dependencies;
+
+    // the output is taken from the last compilation
+    bool reused;
+    // the range of statements in the css stylesheet
+    size_t cssBegin;
+    size_t cssEnd;
+
+    std::string css;
+    // the column of the writer after the css, and whether the css
+    // contains a line break that reset the column.
+    unsigned int column;
+    bool newline;
+
+    Node()
+        : ordinal(0),
+          reference(false),
+          reused(false),
+          cssBegin(0),
+          cssEnd(0),
+          column(0),
+          newline(false) {
+    }
+  };
+  struct File {
+    std::string name;
+    std::shared_ptr<const ImportCache::Entry> entry;
+  };
+
+  const LessStylesheet *stylesheet;
+
+  std::vector<Node> nodes;
+  std::vector<File> files;
+  std::map<std::string, unsigned int> ordinals;
+  bool extensions;
+
+  // the last compilation that was written
+  std::vector<Node> previous;
+  std::vector<File> previousFiles;
+  bool previousExtensions;
+
+  unsigned int reused;
+
+  bool getChanges(std::set<std::string> &changed,
+                  Dependencies &names) const;
+  bool isAffected(const Node &node,
+                  const std::set<std::string> &changed,
+                  const Dependencies &names) const;
+  void processNode(const StylesheetStatement &statement,
+                   Node &node,
+                   Stylesheet &css,
+                   ProcessingContext &context);
+};
+
+#endif  // __less_lessstylesheet_DependencyGraph_h__
@@ -3,6 +3,7 @@
 
 #include <list>
 
+#include "less/Symbol.h"
 #include "less/TokenList.h"
 #include "less/stylesheet/Ruleset.h"
 
@@ -34,9 +35,21 @@ public:
                                  const Mixin &mixin,
                                  const ProcessingContext &context) const = 0;
 
-  virtual const TokenList *getVariable(const std::string &key,
+  virtual const TokenList *getVariable(const Symbol &key,
                                        const ProcessingContext &context) const = 0;
 
+  /**
+   * Look up a variable among the variables defined in the function
+   * itself, without its arguments or the scopes around it.
+   */
+  virtual const TokenList *getLocalVariable(const Symbol &key) const = 0;
+
+  /**
+   * The function whose scope getVariable() continues in after the
+   * function's own scope, or NULL if it continues somewhere else.
+   */
+  virtual const Function *getParentScope() const = 0;
+
   virtual const LessSelector& getLessSelector() const = 0;
 };
 
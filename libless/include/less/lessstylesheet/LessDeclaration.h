@@ -3,16 +3,37 @@
 
 #include "less/stylesheet/Declaration.h"
 #include "less/stylesheet/Ruleset.h"
+#include "less/value/CompiledValue.h"
 
 class LessRuleset;
 
 class LessDeclaration : public Declaration {
   LessRuleset *lessRuleset;
 
+  /**
+   * The value is compiled the second time it is processed, so the
+   * declarations of a mixin are parsed once however often it is
+   * called, and declarations that are processed once are not compiled
+   * at all.
+   */
+  mutable CompiledValue *compiledValue;
+  mutable bool processed;
+  bool folded;
+
 public:
+  LessDeclaration();
+  virtual ~LessDeclaration();
+
   void setLessRuleset(LessRuleset &r);
   LessRuleset *getLessRuleset();
 
+  /**
+   * Process the value now if it is static, which is processed the same
+   * way in any scope; process() copies a folded value as it is. Call it
+   * once the value is set.
+   */
+  void foldValue();
+
   virtual void process(Ruleset &r, void* context) const;
 
 };
@@ -28,11 +28,16 @@ public:
   void setSelector(const TokenList &s);
 
   const LessStylesheet &getLessStylesheet() const;
+  /**
+   * Media queries are only added to a LessStylesheet, which becomes the
+   * parent of the query as well.
+   */
+  virtual void setStylesheet(Stylesheet *s);
 
   virtual void getFunctions(std::list<const Function *> &functionList,
                             const Mixin &mixin,
                             const ProcessingContext &context) const;
-  virtual const TokenList *getVariable(const std::string &key,
+  virtual const TokenList *getVariable(const Symbol &key,
                                        const ProcessingContext &context) const;
 
   virtual void process(Stylesheet &s, void* context) const;
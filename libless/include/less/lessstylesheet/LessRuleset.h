@@ -20,6 +20,7 @@
 #include "less/lessstylesheet/LessSelector.h"
 #include "less/lessstylesheet/Mixin.h"
 #include "less/lessstylesheet/MixinArguments.h"
+#include "less/lessstylesheet/MixinIndex.h"
 #include "less/lessstylesheet/ProcessingContext.h"
 #include "less/lessstylesheet/LessDeclaration.h"
 #include "less/lessstylesheet/LessAtRule.h"
@@ -32,6 +33,8 @@ class LessRuleset : public Ruleset, public Function {
 protected:
   VariableMap variables;
   std::list<LessRuleset *> nestedRules;
+  // the nested rules by their selectors
+  MixinIndex nestedRuleIndex;
   std::list<Closure *> closures;
   std::list<Extension> extensions;
 
@@ -86,6 +89,7 @@ public:
   const list<StylesheetStatement *> &getStylesheetStatements() const;
 
   const list<LessRuleset *> &getNestedRules() const;
+  const MixinIndex &getNestedRuleIndex() const;
 
   void putVariable(const std::string &key, const TokenList &value);
   VariableMap &getVariables();
@@ -100,6 +104,11 @@ public:
   const LessRuleset *getParent() const;
 
   void setLessStylesheet(const LessStylesheet &stylesheet);
+  /**
+   * Rulesets are only added to a LessStylesheet, which becomes the Less
+   * stylesheet of the ruleset as well.
+   */
+  virtual void setStylesheet(Stylesheet *s);
   const LessStylesheet *getLessStylesheet() const;
 
   void processExtensions(ProcessingContext &context,
@@ -124,8 +133,10 @@ public:
                        const Selector *prefix,
                        ProcessingContext &context) const;
 
-  const TokenList* getVariable(const std::string& key,
+  const TokenList* getVariable(const Symbol& key,
                                const ProcessingContext &context) const ;
+  virtual const TokenList *getLocalVariable(const Symbol &key) const;
+  virtual const Function *getParentScope() const;
 
   virtual void getFunctions(list<const Function *> &functionList,
                             const Mixin &mixin,
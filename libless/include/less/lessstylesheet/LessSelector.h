@@ -9,6 +9,7 @@
 #include "less/lessstylesheet/MixinArguments.h"
 #include "less/lessstylesheet/Extension.h"
 #include "less/stylesheet/Selector.h"
+#include "less/value/Condition.h"
 
 class LessSelector : public Selector {
 private:
@@ -16,9 +17,11 @@ private:
   std::list<std::string> parameters;
   std::list<TokenList> defaults;
   std::list<TokenList> conditions;
+  std::list<Condition> compiledConditions;
 
   bool _unlimitedArguments;
   bool _needsArguments;
+  bool _usesDefault;
   std::string restIdentifier;
 
 public:
@@ -38,6 +41,15 @@ public:
   const TokenList *getDefault(const std::string &parameter) const;
 
   const std::list<TokenList> &getConditions() const;
+  /**
+   * The conditions, compiled when they are added.
+   */
+  const std::list<Condition> &getCompiledConditions() const;
+  /**
+   * True if a condition calls default(). The other conditions have the
+   * same result whatever default() returns.
+   */
+  bool usesDefault() const;
   bool matchArguments(const MixinArguments &arguments) const;
 
   bool needsArguments() const;
@@ -13,13 +13,14 @@
 #include "less/lessstylesheet/LessAtRule.h"
 #include "less/lessstylesheet/LessRuleset.h"
 #include "less/lessstylesheet/Mixin.h"
+#include "less/lessstylesheet/MixinIndex.h"
 #include "less/lessstylesheet/ProcessingContext.h"
 
 class LessMediaQuery;
 
 class LessStylesheet : public Stylesheet {
 private:
-  std::multimap<TokenList, LessRuleset *> lessrulesets;
+  MixinIndex lessrulesets;
 
   VariableMap variables;
 
@@ -37,6 +38,13 @@ public:
   void deleteLessRuleset(LessRuleset &ruleset);
   void deleteMixin(Mixin &mixin);
 
+  /**
+   * Move the statements and variables of stylesheet to the end of this
+   * stylesheet, as if they had been parsed after the statements of this
+   * stylesheet. Variables of stylesheet replace those with the same name.
+   */
+  void splice(LessStylesheet &stylesheet);
+
   void putVariable(const std::string &key, const TokenList &value);
 
   virtual void getFunctions(std::list<const Function *> &functionList,
@@ -44,7 +52,7 @@ public:
                             const ProcessingContext &context) const;
 
   const TokenList *getVariable(const std::string &key) const;
-  virtual const TokenList *getVariable(const std::string &key,
+  virtual const TokenList *getVariable(const Symbol &key,
                                        const ProcessingContext &context) const;
 
   virtual void process(Stylesheet &s, void *context) const;
@@ -37,6 +37,11 @@ public:
   bool isImportant() const;
   
   const LessStylesheet *getLessStylesheet() const;
+  /**
+   * Mixins are only added to a LessStylesheet, which becomes the Less
+   * stylesheet of the mixin as well.
+   */
+  virtual void setStylesheet(Stylesheet *s);
 
   const LessRuleset *getLessRuleset() const;
 
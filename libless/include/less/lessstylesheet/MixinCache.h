@@ -0,0 +1,81 @@
+#ifndef __less_lessstylesheet_MixinCache_h__
+#define __less_lessstylesheet_MixinCache_h__
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Function;
+class Mixin;
+class ProcessingContext;
+
+/**
+ * The functions that were found for each mixin call, so a call that is
+ * made again from the same function does not look them up again.
+ *
+ * Apart from the calling function, a lookup depends on the closures of
+ * the scopes it searched and on the variables in the guards of
+ * namespaces. The cache records the versions of the closures that are
+ * searched while a lookup is made, and the result is only reused while
+ * they are the same. A lookup that reads a variable is not stored.
+ *
+ * Only one lookup is recorded at a time; mixin lookups do not nest.
+ */
+class MixinCache {
+public:
+  MixinCache();
+
+  /**
+   * @return the functions that were found for mixin when it was called
+   *         from caller, or NULL if they are not stored, were found
+   *         for another caller, or the closures they were found in
+   *         changed since.
+   */
+  const std::list<const Function *> *get(
+      const Mixin &mixin,
+      const Function *caller,
+      const ProcessingContext &context) const;
+
+  /**
+   * Start recording a lookup; it ends with put() or abort().
+   */
+  void begin();
+  void abort();
+
+  /**
+   * Record that the closures of scope, NULL for the base closures, were
+   * searched at version.
+   */
+  void addClosures(const Function *scope, unsigned int version);
+
+  /**
+   * Record that a variable was read, so the lookup is not stored.
+   */
+  void addVariable();
+
+  /**
+   * Store the functions that were found for mixin, ending the lookup
+   * that was started with begin().
+   */
+  void put(const Mixin &mixin,
+           const Function *caller,
+           const std::list<const Function *> &functions);
+
+private:
+  typedef std::pair<const Function *, unsigned int> ClosureVersion;
+
+  struct Entry {
+    const Function *caller;
+    std::list<const Function *> functions;
+    std::vector<ClosureVersion> closures;
+  };
+
+  std::unordered_map<const Mixin *, Entry> entries;
+
+  bool recording;
+  bool cacheable;
+  std::vector<ClosureVersion> closures;
+};
+
+#endif  // __less_lessstylesheet_MixinCache_h__
@@ -1,8 +1,10 @@
 #ifndef __less_lessstylesheet_MixinCall_h__
 #define __less_lessstylesheet_MixinCall_h__
 
+#include <list>
 #include "less/TokenList.h"
 #include "less/VariableMap.h"
+#include "less/lessstylesheet/VariableCache.h"
 
 class Function;
 class Mixin;
@@ -14,13 +16,24 @@ public:
   const Function* function;
   VariableMap arguments;
   bool savepoint, important;
+  // the function is a ruleset that is processed inside the function of
+  // the parent call, and it is not further down the stack
+  bool nested;
+  // the function, or one further down the stack, was called by a mixin
+  // rather than processed, so the statements in it can run more than
+  // once
+  bool called;
+
+  // the variables that were looked up while the call was on top of the
+  // stack
+  mutable VariableCache resolved;
 
   MixinCall(MixinCall* parent,
             const Function& function,
             bool savepoint = false,
             bool important = false);
 
-  const TokenList* getVariable(const std::string& key,
+  const TokenList* getVariable(const Symbol& key,
                                const ProcessingContext &context) const;
   void getFunctions(std::list<const Function*>& functionList,
                     const Mixin& mixin,
@@ -0,0 +1,87 @@
+#ifndef __less_lessstylesheet_MixinIndex_h__
+#define __less_lessstylesheet_MixinIndex_h__
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "less/Token.h"
+#include "less/TokenList.h"
+
+class Function;
+class Mixin;
+class ProcessingContext;
+
+/**
+ * The functions of a scope by the first element of each part of their
+ * selectors, so a mixin call only walks the selectors that can match
+ * its name.
+ *
+ * The key of a part is its first token, or the first two for a class,
+ * which the tokenizer splits in a '.' and an identifier. A leading '>'
+ * and the whitespace after it are skipped as in Selector::walk(). A
+ * part can only match a name with the same key, except for a part that
+ * is nothing but '.', which is not added. A function is listed once for
+ * each of its parts; the entries of a key are kept in the order they
+ * were added.
+ */
+class MixinIndex {
+public:
+  struct Entry {
+    const Function *function;
+    const TokenList *selector;
+  };
+  typedef std::vector<Entry> Bucket;
+
+  MixinIndex();
+
+  /**
+   * Add an entry for each part of the selector of function.
+   */
+  void add(const Function &function);
+  void remove(const Function &function);
+
+  /**
+   * Add the entries of index after the entries of this index.
+   */
+  void splice(MixinIndex &index);
+
+  /**
+   * Changes each time functions are added to or removed from the index.
+   */
+  unsigned int getVersion() const;
+
+  /**
+   * The entries for the element at offset in a mixin name, or NULL if
+   * there are none.
+   */
+  const Bucket *find(TokenList::const_iterator offset,
+                     TokenList::const_iterator end) const;
+
+  /**
+   * Look for mixin in the functions that are found for the element at
+   * offset, in the order they were added, with
+   * Function::getFunctions(). Each function is searched once.
+   */
+  void getFunctions(std::list<const Function *> &functionList,
+                    const Mixin &mixin,
+                    TokenList::const_iterator offset,
+                    const Function *exclude,
+                    const ProcessingContext &context) const;
+
+private:
+  std::unordered_map<std::string, Bucket> buckets;
+  unsigned int version;
+
+  /**
+   * The key of the selector or name that starts at it.
+   *
+   * @return false if there is no element to make a key of.
+   */
+  static bool getKey(TokenList::const_iterator it,
+                     TokenList::const_iterator end,
+                     std::string &key);
+};
+
+#endif  // __less_lessstylesheet_MixinIndex_h__
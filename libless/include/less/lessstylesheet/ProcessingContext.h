@@ -10,10 +10,15 @@
 #include "less/lessstylesheet/Closure.h"
 #include "less/lessstylesheet/Extension.h"
 #include "less/lessstylesheet/Function.h"
+#include "less/lessstylesheet/MixinCache.h"
 #include "less/lessstylesheet/MixinCall.h"
+#include "less/lessstylesheet/MixinIndex.h"
+#include "less/value/ValueCache.h"
 #include "less/value/ValueProcessor.h"
 #include "less/value/ValueScope.h"
 
+class DependencyGraph;
+struct Dependencies;
 class LessRuleset;
 class Function;
 class Closure;
@@ -29,23 +34,74 @@ private:
 
   const LessStylesheet *contextStylesheet;
 
+  DependencyGraph *dependencyGraph;
+  Dependencies *dependencies;
+
   // return values
-  std::map<const Function*, std::list<Closure *> > closures;
+  std::map<const Function*, MixinIndex> closures;
   std::map<const Function*, VariableMap> variables;
-  std::list<Closure *> base_closures;
+  MixinIndex base_closures;
   VariableMap base_variables;
+
+  // changed when variables are added to a scope, which can hide the
+  // variables that were looked up before
+  unsigned int generation;
+
+  mutable ValueCache values;
+  mutable MixinCache mixins;
+
+  /**
+   * Look up a variable as if call is on top of the stack.
+   *
+   * @param nested true if the lookup is made for a ruleset inside the
+   *               call, in which case the result is remembered in call.
+   */
+  const TokenList *resolveVariable(const Symbol &key,
+                                   const MixinCall &call,
+                                   bool nested) const;
+
 public:
   ProcessingContext();
 
   void setLessStylesheet(const LessStylesheet &stylesheet);
   const LessStylesheet *getLessStylesheet() const;
 
+  /**
+   * If set, the stylesheet of the graph is processed through the graph.
+   */
+  void setDependencyGraph(DependencyGraph *graph);
+  DependencyGraph *getDependencyGraph() const;
+
+  /**
+   * If set, the variables and mixins that are looked up, and additions
+   * to the root scope, are recorded in dependencies.
+   */
+  void setDependencies(Dependencies *dependencies);
+
+  /**
+   * Look up a variable in the scope of the mixin call on top of the
+   * stack, or in the stylesheet if the stack is empty.
+   *
+   * A ruleset that is processed inside its parent continues the lookup
+   * in the call of the parent, which remembers the result for the other
+   * rulesets inside it, so a variable is found in about constant time
+   * however deep the rulesets are nested. The results are forgotten
+   * when variables are added with addVariables().
+   */
   virtual const TokenList *getVariable(const std::string &key) const;
+  virtual const TokenList *getVariable(const Symbol &key) const;
+
+  /**
+   * The values of variables are kept until variables are added with
+   * addVariables(), and are reused wherever the variables they refer to
+   * are the same.
+   */
+  virtual ValueCache *getValueCache() const;
 
-  const TokenList *getFunctionVariable(const std::string &key,
+  const TokenList *getFunctionVariable(const Symbol &key,
                                        const Function* function) const;
 
-  const TokenList *getBaseVariable (const std::string &key) const;
+  const TokenList *getBaseVariable (const Symbol &key) const;
   
   
   void pushMixinCall(const Function &function,
@@ -60,11 +116,26 @@ public:
   const Function* getSavePoint() const;
   bool isImportant() const;
 
+  /**
+   * Look up the functions that mixin calls. Inside a mixin call, the
+   * result is reused when the same mixin is called from the same
+   * function again, as long as the closures it was found in stay the
+   * same.
+   */
   void getFunctions(std::list<const Function *> &functionList,
                     const Mixin &mixin) const;
 
-  const std::list<Closure *> *getClosures(const Function *function) const ;
-  const std::list<Closure *> *getBaseClosures() const;
+  /**
+   * The closures that were added in the scope of function, or NULL if
+   * there are none.
+   */
+  const MixinIndex *getClosures(const Function *function) const ;
+  const MixinIndex *getBaseClosures() const;
+  /**
+   * The version of the closures of function, or of the base closures if
+   * function is NULL; 0 if none were added.
+   */
+  unsigned int getClosureVersion(const Function *function) const;
   
   void addClosure(const LessRuleset &ruleset);
   void addVariables(const VariableMap &variables);
@@ -81,8 +152,11 @@ public:
   void interpolate(TokenList &tokens) const;
   void interpolate(std::string &str) const;
   void processValue(TokenList &value) const;
+  void processValue(const CompiledValue &value, TokenList &result) const;
   bool validateCondition(const TokenList &value,
                          bool defaultVal = false) const;
+  bool validateCondition(const Condition &condition,
+                         bool defaultVal = false) const;
 };
 
 #endif  // __less_lessstylesheet_ProcessingContext_h__
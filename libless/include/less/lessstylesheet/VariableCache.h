@@ -0,0 +1,47 @@
+#ifndef __less_lessstylesheet_VariableCache_h__
+#define __less_lessstylesheet_VariableCache_h__
+
+#include <cstddef>
+#include <vector>
+#include "less/Symbol.h"
+#include "less/TokenList.h"
+
+/**
+ * The results of variable lookups in a scope, by symbol id, in an open
+ * addressing hash table. A lookup that found nothing is remembered as
+ * well.
+ *
+ * The results belong to a generation of the scope; they are forgotten
+ * when the cache is used with another generation.
+ */
+class VariableCache {
+public:
+  VariableCache();
+
+  /**
+   * Forget the results if they were not stored in generation.
+   */
+  void setGeneration(unsigned int generation);
+
+  /**
+   * @return false if key was not looked up yet.
+   */
+  bool get(const Symbol &key, const TokenList *&value) const;
+  void put(const Symbol &key, const TokenList *value);
+
+private:
+  struct Slot {
+    // the id of the symbol, 0 if the slot is empty
+    unsigned int id;
+    const TokenList *value;
+  };
+
+  // empty until the first result is stored, then a power of two
+  std::vector<Slot> slots;
+  size_t size;
+  unsigned int generation;
+
+  size_t findSlot(unsigned int id) const;
+};
+
+#endif  // __less_lessstylesheet_VariableCache_h__
@@ -1,9 +1,10 @@
 #ifndef __less_stylesheet_CssWritable_h__
 #define __less_stylesheet_CssWritable_h__
 
+#include "less/Arena.h"
 #include "less/css/CssWriter.h"
 
-class CssWritable {
+class CssWritable : public ArenaObject {
 public:
   virtual void write(CssWriter &css) const = 0;
 };
@@ -2,6 +2,7 @@
 #define __less_stylesheet_Selector_h__
 
 #include <list>
+#include "less/Arena.h"
 #include "less/TokenList.h"
 
 /**
@@ -11,7 +12,7 @@
  * For example <code>p .class, a:hover</code> is split up into
  * <code>p .class</code> and <code>a:hover</code>.
  */
-class Selector: public std::list<TokenList> {
+class Selector: public std::list<TokenList>, public ArenaObject {
 protected:
   
 public:
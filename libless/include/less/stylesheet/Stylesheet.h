@@ -29,6 +29,11 @@ protected:
   virtual void addAtRule(AtRule &rule);
   void deleteStatement(StylesheetStatement &statement);
 
+  /**
+   * Move the statements of s to the end of this stylesheet.
+   */
+  void splice(Stylesheet &s);
+
 public:
   Stylesheet() {
   }
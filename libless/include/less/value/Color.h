@@ -17,15 +17,28 @@ using namespace std;
 
 class FunctionLibrary;
 
+/**
+ * An RGBA color. The tokens of a color that was computed are only
+ * written when they are read.
+ */
 class Color : public Value {
 private:
   unsigned int color[3];
   double alpha;
+  /**
+   * False while the tokens do not show the color.
+   */
+  mutable bool formatted;
 
   double maxArray(double* array, const size_t len) const;
   double minArray(double* array, const size_t len) const;
 
-  void updateTokens();
+  /**
+   * Mark the tokens as out of date. Until they are written the first
+   * token only holds the location of the color.
+   */
+  void clearTokens();
+  void updateTokens() const;
 
   bool parseHash(const char* hash);
   
@@ -37,7 +50,7 @@ public:
   Color(const Color& color);
   Color(const Token &name, const char* hash);
 
-  static std::map<string,const char*> ColorNames;
+  static const std::map<string,const char*> ColorNames;
   
   static Color* fromName(const Token &name);
   
@@ -52,6 +65,10 @@ public:
 
   virtual ~Color();
 
+  virtual const TokenList* getTokens() const;
+
+  virtual Value* clone() const;
+
   virtual Value* add(const Value& v) const;
   virtual Value* substract(const Value& v) const;
   virtual Value* multiply(const Value& v) const;
@@ -0,0 +1,49 @@
+#ifndef __less_value_CompiledValue_h__
+#define __less_value_CompiledValue_h__
+
+#include <cstddef>
+#include <vector>
+#include "less/Arena.h"
+#include "less/value/Expression.h"
+
+/**
+ * A declaration value, compiled once by ValueProcessor::compileValue().
+ *
+ * The value is a sequence of segments: a statement that is evaluated,
+ * or tokens that are copied to the result as they are, such as commas
+ * and calls to functions that are not LESS functions. Statements that
+ * do not refer to the scope are evaluated when the value is compiled.
+ * A value that does not need processing has no segments; only its
+ * strings are interpolated.
+ */
+class CompiledValue : public Expression, public ArenaObject {
+public:
+  enum Kind {
+    // tokens that are copied as they are
+    LITERAL,
+    // a statement that is evaluated
+    STATEMENT,
+    // a statement that was evaluated when the value was compiled
+    CONSTANT
+  };
+
+  struct Segment {
+    Kind kind;
+    // the first token, the statement, or the constant
+    size_t index;
+    // the index after the last token of the segment
+    size_t end;
+  };
+
+  CompiledValue(const TokenList &tokens);
+
+  const std::vector<Segment> &getSegments() const;
+  void addSegment(Kind kind, size_t index, size_t end);
+
+  virtual void clear();
+
+private:
+  std::vector<Segment> segments;
+};
+
+#endif  // __less_value_CompiledValue_h__
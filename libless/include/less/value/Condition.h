@@ -0,0 +1,28 @@
+#ifndef __less_value_Condition_h__
+#define __less_value_Condition_h__
+
+#include "less/value/Expression.h"
+
+/**
+ * A guard condition, compiled once by ValueProcessor::compileCondition().
+ *
+ * Each statement that is joined with 'and' is a statement of the
+ * expression; an empty statement is false.
+ */
+class Condition : public Expression {
+public:
+  Condition(const TokenList &tokens);
+
+  /**
+   * A condition that starts with 'not' is negated as a whole.
+   */
+  bool isNegated() const;
+  void setNegated(bool negated);
+
+  virtual void clear();
+
+private:
+  bool negated;
+};
+
+#endif  // __less_value_Condition_h__
@@ -0,0 +1,101 @@
+#ifndef __less_value_Expression_h__
+#define __less_value_Expression_h__
+
+#include <cstddef>
+#include <vector>
+#include "less/Symbol.h"
+#include "less/TokenList.h"
+
+class Value;
+
+/**
+ * Tokens that are compiled once by the ValueProcessor so they can be
+ * evaluated without parsing them again.
+ *
+ * Each statement is kept as instructions in postfix order. Numbers and
+ * identifiers are turned into values and variable names into symbols
+ * when the tokens are compiled; strings and function calls are
+ * evaluated from their tokens. Tokens the compiler does not handle are
+ * evaluated the way they were before.
+ */
+class Expression {
+public:
+  enum Code {
+    // push a copy of a constant
+    CONSTANT,
+    // push the value of a variable
+    VARIABLE,
+    // push the value of default()
+    DEFAULT,
+    // push the value of the tokens from index to end
+    TOKENS,
+    // replace the two values on top with the result of an operator
+    OPERATOR,
+    // set the location of the value on top to the token at index
+    LOCATION
+  };
+
+  struct Instruction {
+    Code code;
+    // the constant, the first token, or the ValueProcessor::Operator
+    size_t index;
+    // for TOKENS, the index after the last token; for OPERATOR, the
+    // operator token; for VARIABLE, the symbol of the name
+    size_t end;
+  };
+  typedef std::vector<Instruction> Statement;
+
+  Expression(const TokenList &tokens);
+  Expression(const Expression &expression);
+  virtual ~Expression();
+
+  Expression &operator=(const Expression &expression);
+
+  const TokenList &getTokens() const;
+
+  /**
+   * False if the tokens could not be compiled.
+   */
+  bool isCompiled() const;
+  void setCompiled(bool compiled);
+
+  const std::vector<Statement> &getStatements() const;
+  const Value &getConstant(size_t index) const;
+  const Symbol &getSymbol(size_t index) const;
+
+  /**
+   * Start a statement; the instructions that follow are added to it.
+   */
+  void addStatement();
+  void addInstruction(Code code, size_t index, size_t end = 0);
+  /**
+   * Add an instruction that pushes value, which the expression takes
+   * over.
+   */
+  void addConstant(Value *value);
+  /**
+   * Keep value, which the expression takes over, without an
+   * instruction.
+   *
+   * @return the index of the constant.
+   */
+  size_t storeConstant(Value *value);
+  /**
+   * @return the index of symbol.
+   */
+  size_t storeSymbol(const Symbol &symbol);
+
+  /**
+   * Forget the compiled statements.
+   */
+  virtual void clear();
+
+private:
+  TokenList tokens;
+  bool compiled;
+  std::vector<Statement> statements;
+  std::vector<Value *> constants;
+  std::vector<Symbol> symbols;
+};
+
+#endif  // __less_value_Expression_h__
@@ -4,6 +4,7 @@
 #include <cstring>
 #include <map>
 #include <vector>
+#include "less/Symbol.h"
 #include "less/value/Value.h"
 
 typedef struct FuncInfo {
@@ -13,10 +14,12 @@ typedef struct FuncInfo {
 
 class FunctionLibrary {
 private:
-  std::map<std::string, FuncInfo*> map;
+  // functions by interned name
+  std::map<Symbol, FuncInfo*> map;
 
 public:
   const FuncInfo* getFunction(const char* functionName) const;
+  const FuncInfo* getFunction(const Symbol& functionName) const;
 
   void push(string name,
             const char* parameterTypes,
@@ -9,9 +9,30 @@
 
 class FunctionLibrary;
 
+/**
+ * A number, percentage or dimension. The number and the unit are kept
+ * as they are computed and the token is only written when it is read,
+ * so intermediate results of an expression are never formatted.
+ */
 class NumberValue : public Value {
+  double value;
+  /**
+   * The characters after the number: the unit of a dimension, "%" for
+   * a percentage.
+   */
+  std::string suffix;
+  /**
+   * False while the token does not show the value and the unit.
+   */
+  mutable bool formatted;
+
   static bool isNumber(const Value &val);
 
+  /**
+   * Read the value and the suffix from the characters of a number.
+   */
+  void parse(const std::string &number);
+
   void verifyUnits(const NumberValue &n);
   double convert(const std::string &unit) const;
 
@@ -22,6 +43,10 @@ public:
   NumberValue(const NumberValue &n);
   virtual ~NumberValue();
 
+  virtual const TokenList *getTokens() const;
+
+  virtual Value *clone() const;
+
   virtual Value *add(const Value &v) const;
   virtual Value *substract(const Value &v) const;
   virtual Value *multiply(const Value &v) const;
@@ -27,6 +27,8 @@ public:
 
   virtual ~UrlValue();
 
+  virtual Value *clone() const;
+
   std::string getPath() const;
 
   std::string getRelativePath() const;
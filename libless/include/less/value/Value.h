@@ -12,7 +12,10 @@ class BooleanValue;
  */
 class Value {
 protected:
-  TokenList tokens;
+  /**
+   * Subclasses may write the tokens when they are first read.
+   */
+  mutable TokenList tokens;
 
 public:
   enum Type {
@@ -33,6 +36,17 @@ public:
 
   virtual const TokenList* getTokens() const;
 
+  /**
+   * A copy of the value with the same tokens.
+   */
+  virtual Value* clone() const = 0;
+
+  /**
+   * The operations return a new value, or NULL if the operation is not
+   * defined for the types of the values, for example when a keyword is
+   * divided by a number in a shorthand like `center / cover`. The value
+   * processor then keeps the tokens as they are.
+   */
   virtual Value* add(const Value& v) const = 0;
   virtual Value* substract(const Value& v) const = 0;
   virtual Value* multiply(const Value& v) const = 0;
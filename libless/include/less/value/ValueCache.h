@@ -0,0 +1,131 @@
+#ifndef __less_value_ValueCache_h__
+#define __less_value_ValueCache_h__
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "less/Symbol.h"
+#include "less/TokenList.h"
+
+class Value;
+class ValueScope;
+
+/**
+ * The evaluated values of variables, by the definition of the variable.
+ *
+ * A value is evaluated in the scope where the variable is used, so the
+ * same definition can have another value somewhere else. The cache
+ * records the variables that are looked up while a value is evaluated,
+ * and a value is only reused in a scope where each of them resolves to
+ * the same definition.
+ *
+ * The definitions must live as long as the cache. The values belong to
+ * a generation of the scope; they are forgotten when the cache is used
+ * with another generation.
+ */
+class ValueCache {
+public:
+  ValueCache();
+  ~ValueCache();
+
+  /**
+   * Forget the values if they were not stored in generation.
+   */
+  void setGeneration(unsigned int generation);
+
+  /**
+   * Record that key resolved to value, for the values that are being
+   * evaluated. A lookup of a name that was never interned is recorded
+   * with the null symbol; the values that depend on it are not stored.
+   */
+  void addLookup(const Symbol &key, const TokenList *value);
+
+  /**
+   * Start evaluating a value; the lookups that follow are recorded for
+   * it until it is stored, or until abort() is called.
+   */
+  void begin();
+  void abort();
+
+  /**
+   * @return the processed tokens of variable, or NULL if they are not
+   *         stored or were evaluated with other variables than the
+   *         ones scope resolves to.
+   */
+  const TokenList *getTokens(const TokenList &variable,
+                             const ValueScope &scope);
+  /**
+   * Store the processed tokens of variable, ending the evaluation that
+   * was started with begin().
+   */
+  void putTokens(const TokenList &variable, const TokenList &tokens);
+
+  /**
+   * Look up the result of processing variable as a single value.
+   *
+   * @param value  set to a copy of the value, which the caller owns, or
+   *               to NULL if variable is not a value
+   * @param failed set if variable contains an operation that is not
+   *               defined for its operands
+   * @return false if the result is not stored, or was evaluated with
+   *         other variables than the ones scope resolves to.
+   */
+  bool getValue(const TokenList &variable,
+                const ValueScope &scope,
+                Value *&value,
+                bool &failed);
+  /**
+   * Store a copy of value, ending the evaluation that was started with
+   * begin().
+   */
+  void putValue(const TokenList &variable, const Value *value, bool failed);
+
+private:
+  typedef std::pair<Symbol, const TokenList *> Lookup;
+
+  struct Entry {
+    std::vector<Lookup> lookups;
+    TokenList tokens;
+    Value *value;
+    bool failed;
+
+    Entry();
+    ~Entry();
+
+  private:
+    Entry(const Entry &entry);
+    Entry &operator=(const Entry &entry);
+  };
+
+  struct Evaluation {
+    // the index of the first lookup in lookups
+    size_t start;
+    bool cacheable;
+  };
+
+  std::unordered_map<const TokenList *, Entry> tokens;
+  std::unordered_map<const TokenList *, Entry> values;
+  unsigned int generation;
+
+  // the lookups of the values that are being evaluated; the lookups of
+  // a value are part of the values it is nested in as well
+  std::vector<Lookup> lookups;
+  std::vector<Evaluation> evaluations;
+
+  /**
+   * Check that the lookups of entry resolve to the same definitions in
+   * scope. The lookups are repeated through the scope, so they are
+   * recorded for the values that are being evaluated.
+   */
+  bool validate(const Entry &entry, const ValueScope &scope);
+
+  /**
+   * End the evaluation on top and return the entry of variable in map,
+   * or NULL if the value can not be stored.
+   */
+  Entry *end(std::unordered_map<const TokenList *, Entry> &map,
+             const TokenList &variable);
+};
+
+#endif  // __less_value_ValueCache_h__
@@ -8,12 +8,15 @@
 #include "less/TokenList.h"
 #include "less/css/ParseException.h"
 #include "less/value/Color.h"
+#include "less/value/CompiledValue.h"
+#include "less/value/Condition.h"
 #include "less/value/FunctionLibrary.h"
 #include "less/value/NumberValue.h"
 #include "less/value/StringValue.h"
 #include "less/value/UnitValue.h"
 #include "less/value/UrlValue.h"
 #include "less/value/Value.h"
+#include "less/value/ValueCache.h"
 #include "less/value/ValueException.h"
 #include "less/value/ValueScope.h"
 
@@ -36,14 +39,32 @@ public:
   };
 
 private:
-  FunctionLibrary functionLibrary;
+  const FunctionLibrary *functionLibrary;
+
+  /**
+   * A strict processor throws the error of an operation that is not
+   * defined for the types of its operands instead of setting failed.
+   * Conditions that failed are evaluated again by one to report it.
+   */
+  bool strict;
+
+  ValueProcessor(bool strict);
+
+  /*
+   * The process* methods return NULL if the tokens do not start with a
+   * value. They set failed and return NULL if the tokens contain an
+   * operation that is not defined for the types of its operands; the
+   * statement is then not a value, wherever the operation is nested.
+   */
 
   Value *processStatement(const TokenList &tokens,
-                          const ValueScope &scope) const;
+                          const ValueScope &scope,
+                          bool &failed) const;
 
   Value *processStatement(TokenList::const_iterator &it,
                           TokenList::const_iterator &end,
                           const ValueScope &scope,
+                          bool &failed,
                           bool defaultVal = false) const;
 
   Value *processOperation(TokenList::const_iterator &i,
@@ -51,21 +72,56 @@ private:
                           const Value &operand1,
                           const ValueScope &scope,
                           ValueProcessor::Operator lastop,
+                          bool &failed,
                           bool defaultVal = false) const;
 
   Operator processOperator(TokenList::const_iterator &i,
                            TokenList::const_iterator &end) const;
+  /**
+   * @return the result of op, or NULL if it is not defined for the
+   *         types of the operands.
+   */
+  Value *applyOperator(Operator op,
+                       const Value &operand1,
+                       const Value &operand2) const;
+
+  /**
+   * Set failed for op, which is not defined for the types of the
+   * operands, or throw its error if the processor is strict.
+   */
+  void operationFailed(Operator op,
+                       const Value &operand1,
+                       const Value &operand2,
+                       bool &failed) const;
 
   Value *processConstant(TokenList::const_iterator &it,
                          TokenList::const_iterator &end,
                          const ValueScope &scope,
+                         bool &failed,
                          bool defaultVal = false) const;
 
   Value *processSubstatement(TokenList::const_iterator &i,
                              TokenList::const_iterator &end,
                              const ValueScope &scope,
+                             bool &failed,
                              bool defaultVal = false) const;
 
+  /**
+   * The tokens of variable after processValue(), from the value cache
+   * of the scope if it has them. buffer holds the tokens otherwise.
+   */
+  const TokenList &processVariable(const TokenList &variable,
+                                   const ValueScope &scope,
+                                   TokenList &buffer) const;
+
+  /**
+   * Process variable as a single value, through the value cache of the
+   * scope.
+   */
+  Value *processVariableStatement(const TokenList &variable,
+                                  const ValueScope &scope,
+                                  bool &failed) const;
+
   const TokenList *processDeepVariable(TokenList::const_iterator &it,
                                        TokenList::const_iterator &end,
                                        const ValueScope &scope) const;
@@ -73,12 +129,14 @@ private:
   Value *processFunction(const Token &function,
                          TokenList::const_iterator &it,
                          TokenList::const_iterator &end,
-                         const ValueScope &scope) const;
+                         const ValueScope &scope,
+                         bool &failed) const;
 
   bool processArguments(TokenList::const_iterator &it,
                         TokenList::const_iterator &end,
                         const ValueScope &scope,
-                        vector<const Value *> &arguments) const;
+                        vector<const Value *> &arguments,
+                        bool &failed) const;
 
   Value *processEscape(TokenList::const_iterator &it,
                        TokenList::const_iterator &end,
@@ -86,20 +144,75 @@ private:
   UnitValue *processUnit(Token &t) const;
 
   bool needsSpace(const Token &t, bool before) const;
+  /**
+   * Add a space to value before the next value, or before next if it
+   * is not NULL, if both sides need one.
+   */
+  void addSpace(TokenList &value, const Token *next) const;
 
   Value *processNegative(TokenList::const_iterator &it,
                          TokenList::const_iterator &end,
-                         const ValueScope &scope) const;
+                         const ValueScope &scope,
+                         bool &failed) const;
 
   void skipWhitespace(TokenList::const_iterator &i,
                       TokenList::const_iterator &end) const;
 
+  /**
+   * Compile the statement at i the way processStatement() would read
+   * it.
+   *
+   * @return false if it contains something the compiler does not
+   *         handle.
+   */
+  bool compileStatement(Expression &expression,
+                        TokenList::const_iterator &i,
+                        TokenList::const_iterator &end) const;
+  /**
+   * @return false if there is no operation at i. valid is cleared if
+   *         the operation can not be compiled.
+   */
+  bool compileOperation(Expression &expression,
+                        TokenList::const_iterator &i,
+                        TokenList::const_iterator &end,
+                        Operator lastop,
+                        bool &valid) const;
+  bool compileConstant(Expression &expression,
+                       TokenList::const_iterator &i,
+                       TokenList::const_iterator &end) const;
+  bool isStatic(TokenList::const_iterator i,
+                TokenList::const_iterator end) const;
+  /**
+   * True if the statement at i is a number, color or identifier that
+   * is not part of an operation, which processStatement() would return
+   * as it is.
+   */
+  bool isLiteral(TokenList::const_iterator i,
+                 TokenList::const_iterator end) const;
+  /**
+   * Evaluate a compiled statement of expression.
+   *
+   * @return the value of the statement, or NULL if a value in the
+   *         statement is not what the compiler expected; the tokens
+   *         are evaluated then.
+   */
+  Value *evaluateStatement(const Expression &expression,
+                           const Expression::Statement &statement,
+                           const ValueScope &scope,
+                           bool defaultVal) const;
+
   const char *operatorToString(ValueProcessor::Operator o) const;
 
 public:
   ValueProcessor();
   virtual ~ValueProcessor();
 
+  /**
+   * The library of built-in functions. It is created on first use and
+   * shared by all value processors.
+   */
+  static const FunctionLibrary &getFunctionLibrary();
+
   /**
    * Determine if a value contains anything that can be processed.
    *
@@ -110,15 +223,59 @@ public:
 
   void processValue(TokenList &value, const ValueScope &scope) const;
 
+  /**
+   * True if value is processed the same way in any scope: it has no
+   * variables and no interpolated strings.
+   */
+  bool isStatic(const TokenList &value) const;
+  /**
+   * Process a static value, without a scope.
+   *
+   * @return false if processing the value raised an error; the value
+   *         is left as it was.
+   */
+  bool processStatic(TokenList &value) const;
+
+  /**
+   * Compile the tokens of value, which is left uncompiled if it
+   * contains something the compiler does not handle.
+   */
+  void compileValue(CompiledValue &value) const;
+  /**
+   * Process value into result, from its tokens if it is not compiled.
+   */
+  void processValue(const CompiledValue &value,
+                    TokenList &result,
+                    const ValueScope &scope) const;
+
   bool validateCondition(const TokenList &value,
                          const ValueScope &scope,
                          bool defaultVal = false) const;
+
+  /**
+   * Compile the tokens of condition, which is left uncompiled if it
+   * contains something the compiler does not handle.
+   */
+  void compileCondition(Condition &condition) const;
+  /**
+   * Evaluate condition, from its tokens if it is not compiled.
+   */
+  bool validateCondition(const Condition &condition,
+                         const ValueScope &scope,
+                         bool defaultVal = false) const;
   bool validateValue(TokenList::const_iterator &i,
                      TokenList::const_iterator &end,
                      const ValueScope &scope,
                      bool defaultVal = false) const;
 
-  bool functionExists(const char *function) const;
+  bool functionExists(const Token &function) const;
+
+  /**
+   * Look up the variable that token names, using the symbol that is
+   * kept with the token.
+   */
+  const TokenList *findVariable(const Token &token,
+                                const ValueScope &scope) const;
 
   void interpolate(string &str, const ValueScope &scope) const;
   void interpolate(TokenList &tokens, const ValueScope &scope) const;
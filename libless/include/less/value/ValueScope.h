@@ -4,11 +4,30 @@
 #include <list>
 #include <map>
 #include <string>
+#include "less/Symbol.h"
 #include "less/TokenList.h"
 
+class ValueCache;
+
 class ValueScope {
 public:
   virtual const TokenList* getVariable(const std::string& key) const = 0;
+
+  /**
+   * Look up an interned name, which is the same as looking up its
+   * string.
+   */
+  virtual const TokenList* getVariable(const Symbol& key) const {
+    return getVariable(key.getString());
+  }
+
+  /**
+   * The evaluated values of the variables in the scope, or NULL if the
+   * scope does not keep them.
+   */
+  virtual ValueCache* getValueCache() const {
+    return NULL;
+  }
 };
 
 #endif  // __tree_ValueScope_h__
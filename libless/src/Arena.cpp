@@ -0,0 +1,107 @@
+#include "less/Arena.h"
+
+#include <cstddef>
+#include <new>
+
+namespace {
+/**
+ * Every ArenaObject is preceded by a header recording the arena it
+ * came from; the header is padded to keep the object maximally
+ * aligned.
+ */
+union ObjectHeader {
+  Arena* arena;
+  std::max_align_t align;
+};
+
+const size_t ALIGNMENT = alignof(std::max_align_t);
+
+size_t align(size_t size) {
+  return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+}
+
+thread_local Arena* Arena::current = NULL;
+
+Arena::Arena(size_t blockSize)
+    : blocks(NULL), pos(NULL), end(NULL), blockSize(blockSize),
+      allocated(0) {
+}
+
+Arena::~Arena() {
+  Block* b;
+
+  while (blocks != NULL) {
+    b = blocks;
+    blocks = b->next;
+    ::operator delete(b);
+  }
+}
+
+void* Arena::allocateBlock(size_t size) {
+  Block* b = (Block*)::operator new(align(sizeof(Block)) + size);
+
+  b->next = blocks;
+  blocks = b;
+  return (char*)b + align(sizeof(Block));
+}
+
+void* Arena::allocate(size_t size) {
+  char* p;
+
+  size = align(size);
+  allocated += size;
+
+  if (size > (size_t)(end - pos)) {
+    // large requests get a block of their own so the current block
+    // is not abandoned
+    if (size > blockSize / 4)
+      return allocateBlock(size);
+
+    pos = (char*)allocateBlock(blockSize);
+    end = pos + blockSize;
+  }
+  p = pos;
+  pos += size;
+  return p;
+}
+
+size_t Arena::getAllocated() const {
+  return allocated;
+}
+
+Arena* Arena::getCurrent() {
+  return current;
+}
+
+Arena::Scope::Scope(Arena& arena) : previous(current) {
+  current = &arena;
+}
+
+Arena::Scope::~Scope() {
+  current = previous;
+}
+
+void* ArenaObject::operator new(size_t size) {
+  Arena* arena = Arena::getCurrent();
+  ObjectHeader* header;
+
+  if (arena != NULL)
+    header = (ObjectHeader*)arena->allocate(sizeof(ObjectHeader) + size);
+  else
+    header = (ObjectHeader*)::operator new(sizeof(ObjectHeader) + size);
+
+  header->arena = arena;
+  return header + 1;
+}
+
+void ArenaObject::operator delete(void* p) {
+  ObjectHeader* header;
+
+  if (p == NULL)
+    return;
+
+  header = (ObjectHeader*)p - 1;
+  if (header->arena == NULL)
+    ::operator delete(header);
+}
@@ -0,0 +1,31 @@
+#include "less/Symbol.h"
+#include "less/SymbolTable.h"
+
+Symbol::Symbol(const std::string &str) {
+  SymbolTable *table = SymbolTable::getCurrent();
+  SymbolTable &global = SymbolTable::getGlobal();
+
+  if (table == NULL || table == &global) {
+    entry = global.intern(str);
+    return;
+  }
+  if ((entry = table->find(str)) == NULL &&
+      (entry = global.find(str)) == NULL)
+    entry = table->intern(str);
+}
+
+Symbol Symbol::find(const std::string &str) {
+  SymbolTable *table = SymbolTable::getCurrent();
+  const Entry *e = NULL;
+
+  if (table != NULL)
+    e = table->find(str);
+  if (e == NULL)
+    e = SymbolTable::getGlobal().find(str);
+  return Symbol(e);
+}
+
+const std::string &Symbol::getString() const {
+  static const std::string empty;
+  return (entry == NULL) ? empty : entry->str;
+}
@@ -0,0 +1,71 @@
+#include "less/SymbolTable.h"
+
+#include <functional>
+
+thread_local SymbolTable* SymbolTable::current = NULL;
+
+// ids are unique over all tables, so symbols of different tables are
+// never equal.
+static std::atomic<unsigned int> nextId(1);
+
+SymbolTable::SymbolTable() : count(0) {
+}
+
+SymbolTable::~SymbolTable() {
+  std::unordered_map<std::string, Symbol::Entry*>::iterator it;
+
+  for (size_t i = 0; i < SHARDS; i++) {
+    for (it = shards[i].entries.begin(); it != shards[i].entries.end(); it++)
+      delete it->second;
+  }
+}
+
+size_t SymbolTable::size() const {
+  return count;
+}
+
+SymbolTable* SymbolTable::getCurrent() {
+  return current;
+}
+
+SymbolTable& SymbolTable::getGlobal() {
+  // never deleted, so symbols stay valid while static objects are
+  // destroyed.
+  static SymbolTable* global = new SymbolTable();
+  return *global;
+}
+
+SymbolTable::Scope::Scope(SymbolTable& table) : previous(current) {
+  current = &table;
+}
+
+SymbolTable::Scope::~Scope() {
+  current = previous;
+}
+
+SymbolTable::Shard& SymbolTable::getShard(const std::string& str) {
+  return shards[std::hash<std::string>()(str) % SHARDS];
+}
+
+const Symbol::Entry* SymbolTable::find(const std::string& str) {
+  Shard& shard = getShard(str);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  std::unordered_map<std::string, Symbol::Entry*>::const_iterator it =
+      shard.entries.find(str);
+
+  return (it != shard.entries.end()) ? it->second : NULL;
+}
+
+const Symbol::Entry* SymbolTable::intern(const std::string& str) {
+  Shard& shard = getShard(str);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  Symbol::Entry*& e = shard.entries[str];
+
+  if (e == NULL) {
+    e = new Symbol::Entry();
+    e->str = str;
+    e->id = nextId++;
+    count++;
+  }
+  return e;
+}
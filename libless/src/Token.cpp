@@ -1,6 +1,6 @@
 #include "less/Token.h"
 
-char Token::BUILTIN_SOURCE[8] = "builtin";
+const char Token::BUILTIN_SOURCE[8] = "builtin";
 
 const Token Token::BUILTIN_SPACE(" ", Token::WHITESPACE, 0, 0, BUILTIN_SOURCE);
 const Token Token::BUILTIN_COMMA(",", Token::OTHER, 0, 0, BUILTIN_SOURCE);
@@ -36,6 +36,7 @@ void Token::setLocation(const Token &ref) {
 
 void Token::clear() {
   std::string::clear();
+  symbol = Symbol();
   type = OTHER;
 }
 
@@ -44,6 +45,7 @@ bool Token::stringHasQuotes() const {
 }
 
 void Token::removeQuotes() {
+  symbol = Symbol();
   removeQuotes(*this);
 }
 
@@ -4,9 +4,11 @@ TokenList::~TokenList() {
 }
 
 void TokenList::ltrim() {
-  while (!empty() && front().type == Token::WHITESPACE) {
-    pop_front();
-  }
+  iterator it = begin();
+
+  while (it != end() && (*it).type == Token::WHITESPACE)
+    it++;
+  erase(begin(), it);
 }
 void TokenList::rtrim() {
   while (!empty() && back().type == Token::WHITESPACE) {
@@ -20,7 +22,12 @@ void TokenList::trim() {
 
 std::string TokenList::toString() const {
   std::string str;
-  std::list<Token>::const_iterator it;
+  size_t length = 0;
+  const_iterator it;
+
+  for (it = begin(); it != end(); it++)
+    length += (*it).size();
+  str.reserve(length);
 
   for (it = begin(); it != end(); it++) {
     str.append(*it);
@@ -33,7 +40,7 @@ bool TokenList::contains(const Token &t) const {
 }
 
 bool TokenList::contains(Token::Type type, const std::string &str) const {
-  std::list<Token>::const_iterator it;
+  const_iterator it;
 
   for (it = begin(); it != end(); it++) {
     if ((*it).type == type && *it == str)
@@ -43,7 +50,7 @@ bool TokenList::contains(Token::Type type, const std::string &str) const {
 }
 
 bool TokenList::containsType(Token::Type type) const {
-  std::list<Token>::const_iterator it;
+  const_iterator it;
 
   for (it = begin(); it != end(); it++) {
     if ((*it).type == type)
@@ -1,16 +1,143 @@
 #include "less/VariableMap.h"
 
-const TokenList *VariableMap::getVariable(const std::string &key) const {
-  VariableMap::const_iterator mit;
+#include <tuple>
+
+// maps with up to this many variables are searched without the table
+static const size_t LINEAR_LIMIT = 8;
+
+VariableMap::VariableMap() {
+}
+
+VariableMap::VariableMap(const VariableMap &map) : entries(map.entries) {
+  if (!map.slots.empty())
+    rehash(map.slots.size());
+}
+
+VariableMap &VariableMap::operator=(const VariableMap &map) {
+  if (this != &map) {
+    // the keys are const, so the entries are copied instead of assigned
+    std::list<value_type>(map.entries).swap(entries);
+    slots.clear();
+    if (!map.slots.empty())
+      rehash(map.slots.size());
+  }
+  return *this;
+}
+
+size_t VariableMap::findSlot(unsigned int id) const {
+  size_t mask = slots.size() - 1;
+  // ids are handed out in sequence; multiplying by an odd constant
+  // spreads neighbouring ids over the table.
+  size_t i = (id * 2654435761u) & mask;
+
+  while (slots[i].id != 0 && slots[i].id != id)
+    i = (i + 1) & mask;
+  return i;
+}
+
+void VariableMap::rehash(size_t capacity) {
+  iterator it;
+  size_t i;
+
+  slots.assign(capacity, Slot());
+
+  for (it = entries.begin(); it != entries.end(); it++) {
+    i = findSlot(it->first.getId());
+    slots[i].id = it->first.getId();
+    slots[i].entry = it;
+  }
+}
+
+VariableMap::iterator VariableMap::find(const Symbol &key) {
+  iterator it;
+  size_t i;
+
+  if (!slots.empty()) {
+    i = findSlot(key.getId());
+    return (slots[i].id != 0) ? slots[i].entry : entries.end();
+  }
+
+  for (it = entries.begin(); it != entries.end() && it->first != key; it++) {
+  }
+  return it;
+}
+
+VariableMap::const_iterator VariableMap::find(const Symbol &key) const {
+  return const_cast<VariableMap *>(this)->find(key);
+}
 
-  if ((mit = this->find(key)) != this->end()) {
-    return &mit->second;
-  } else
+VariableMap::iterator VariableMap::add(const Symbol &key) {
+  iterator entry;
+  size_t i;
+
+  entries.emplace_back(std::piecewise_construct,
+                       std::forward_as_tuple(key),
+                       std::forward_as_tuple());
+  entry = --entries.end();
+
+  if (slots.empty()) {
+    if (entries.size() > LINEAR_LIMIT)
+      rehash(LINEAR_LIMIT * 4);
+  } else if (entries.size() * 4 > slots.size() * 3) {
+    // keep the table at most three quarters full
+    rehash(slots.size() * 2);
+  } else {
+    i = findSlot(key.getId());
+    slots[i].id = key.getId();
+    slots[i].entry = entry;
+  }
+  return entry;
+}
+
+TokenList &VariableMap::operator[](const Symbol &key) {
+  iterator it = find(key);
+
+  if (it != entries.end())
+    return it->second;
+  return add(key)->second;
+}
+
+std::pair<VariableMap::iterator, bool> VariableMap::insert(
+    const value_type &value) {
+  return insert(value.first, value.second);
+}
+
+std::pair<VariableMap::iterator, bool> VariableMap::insert(
+    const Symbol &key, const TokenList &value) {
+  iterator it = find(key);
+
+  if (it != entries.end())
+    return std::make_pair(it, false);
+  it = add(key);
+  it->second = value;
+  return std::make_pair(it, true);
+}
+
+void VariableMap::clear() {
+  entries.clear();
+  slots.clear();
+}
+
+const TokenList *VariableMap::getVariable(const Symbol &key) const {
+  const_iterator it;
+
+  if (key.isNull() || (it = find(key)) == entries.end())
     return NULL;
+  return &it->second;
+}
+
+const TokenList *VariableMap::getVariable(const std::string &key) const {
+  Symbol symbol = Symbol::find(key);
+
+  return symbol.isNull() ? NULL : getVariable(symbol);
 }
 
 void VariableMap::merge(const VariableMap &map) {
-  this->insert(map.begin(), map.end());
+  VariableMap::const_iterator it;
+
+  for (it = map.begin(); it != map.end(); ++it) {
+    insert(*it);
+  }
 }
 
 void VariableMap::overwrite(const VariableMap &map) {
@@ -26,7 +153,7 @@ std::string VariableMap::toString() const {
   VariableMap::const_iterator it;
 
   for (it = this->begin(); it != this->end(); ++it) {
-    str.append(it->first);
+    str.append(it->first.getString());
     str.append(": ");
     str.append(it->second.toString());
     str.append("\n");
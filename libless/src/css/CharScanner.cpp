@@ -0,0 +1,228 @@
+#include "less/css/CharScanner.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define LESS_CHARSCANNER_X86
+#include <immintrin.h>
+#endif
+
+typedef const char* (*FindFunction)(
+    const char* p, const char* end, const char* chars, size_t n, bool match);
+typedef size_t (*CountFunction)(const char* p,
+                                const char* end,
+                                const char** last);
+
+/**
+ * Returns the first character in [p, end) that is (match) or is not
+ * (!match) one of the n characters in chars.
+ */
+static const char* findScalar(
+    const char* p, const char* end, const char* chars, size_t n, bool match) {
+  for (; p < end; p++) {
+    if ((memchr(chars, *p, n) != NULL) == match)
+      return p;
+  }
+  return end;
+}
+
+static size_t countScalar(const char* p, const char* end, const char** last) {
+  size_t count = 0;
+
+  *last = NULL;
+  for (; p < end; p++) {
+    if (*p == '\n') {
+      count++;
+      *last = p;
+    }
+  }
+  return count;
+}
+
+#ifdef LESS_CHARSCANNER_X86
+
+static const char* findSse2(
+    const char* p, const char* end, const char* chars, size_t n, bool match) {
+  __m128i set[CharScanner::MAX_CHARS];
+  __m128i block, found;
+  unsigned int mask;
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    set[i] = _mm_set1_epi8(chars[i]);
+
+  for (; end - p >= 16; p += 16) {
+    block = _mm_loadu_si128((const __m128i*)p);
+    found = _mm_setzero_si128();
+    for (i = 0; i < n; i++)
+      found = _mm_or_si128(found, _mm_cmpeq_epi8(block, set[i]));
+
+    mask = (unsigned int)_mm_movemask_epi8(found);
+    if (!match)
+      mask = ~mask & 0xFFFF;
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+  }
+  return findScalar(p, end, chars, n, match);
+}
+
+static size_t countSse2(const char* p, const char* end, const char** last) {
+  const __m128i newline = _mm_set1_epi8('\n');
+  const char* lastBlock = NULL;
+  unsigned int mask, lastMask = 0;
+  size_t count = 0;
+
+  for (; end - p >= 16; p += 16) {
+    mask = (unsigned int)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), newline));
+    if (mask != 0) {
+      count += __builtin_popcount(mask);
+      lastBlock = p;
+      lastMask = mask;
+    }
+  }
+
+  count += countScalar(p, end, last);
+  if (*last == NULL && lastBlock != NULL)
+    *last = lastBlock + 31 - __builtin_clz(lastMask);
+  return count;
+}
+
+__attribute__((target("avx2"))) static const char* findAvx2(
+    const char* p, const char* end, const char* chars, size_t n, bool match) {
+  __m256i set[CharScanner::MAX_CHARS];
+  __m256i block, found;
+  unsigned int mask;
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    set[i] = _mm256_set1_epi8(chars[i]);
+
+  for (; end - p >= 32; p += 32) {
+    block = _mm256_loadu_si256((const __m256i*)p);
+    found = _mm256_setzero_si256();
+    for (i = 0; i < n; i++)
+      found = _mm256_or_si256(found, _mm256_cmpeq_epi8(block, set[i]));
+
+    mask = (unsigned int)_mm256_movemask_epi8(found);
+    if (!match)
+      mask = ~mask;
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+  }
+  return findSse2(p, end, chars, n, match);
+}
+
+__attribute__((target("avx2"))) static size_t countAvx2(const char* p,
+                                                         const char* end,
+                                                         const char** last) {
+  const __m256i newline = _mm256_set1_epi8('\n');
+  const char* lastBlock = NULL;
+  unsigned int mask, lastMask = 0;
+  size_t count = 0;
+
+  for (; end - p >= 32; p += 32) {
+    mask = (unsigned int)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), newline));
+    if (mask != 0) {
+      count += __builtin_popcount(mask);
+      lastBlock = p;
+      lastMask = mask;
+    }
+  }
+
+  count += countSse2(p, end, last);
+  if (*last == NULL && lastBlock != NULL)
+    *last = lastBlock + 31 - __builtin_clz(lastMask);
+  return count;
+}
+
+#endif  // LESS_CHARSCANNER_X86
+
+struct Kernels {
+  CharScanner::Implementation implementation;
+  FindFunction find;
+  CountFunction count;
+};
+
+static bool isSupported(CharScanner::Implementation implementation) {
+  switch (implementation) {
+    case CharScanner::SCALAR:
+      return true;
+#ifdef LESS_CHARSCANNER_X86
+    case CharScanner::SSE2:
+      return true;
+    case CharScanner::AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+static Kernels getKernels(CharScanner::Implementation implementation) {
+  Kernels kernels;
+
+  kernels.implementation = implementation;
+  switch (implementation) {
+#ifdef LESS_CHARSCANNER_X86
+    case CharScanner::AVX2:
+      kernels.find = findAvx2;
+      kernels.count = countAvx2;
+      break;
+    case CharScanner::SSE2:
+      kernels.find = findSse2;
+      kernels.count = countSse2;
+      break;
+#endif
+    default:
+      kernels.find = findScalar;
+      kernels.count = countScalar;
+      break;
+  }
+  return kernels;
+}
+
+static Kernels selectKernels() {
+  if (isSupported(CharScanner::AVX2))
+    return getKernels(CharScanner::AVX2);
+  else if (isSupported(CharScanner::SSE2))
+    return getKernels(CharScanner::SSE2);
+  else
+    return getKernels(CharScanner::SCALAR);
+}
+
+static Kernels& getCurrent() {
+  static Kernels kernels = selectKernels();
+  return kernels;
+}
+
+const char* CharScanner::findAny(const char* p,
+                                 const char* end,
+                                 const char* chars,
+                                 size_t n) {
+  return getCurrent().find(p, end, chars, n, true);
+}
+
+const char* CharScanner::findNotWhitespace(const char* p, const char* end) {
+  return getCurrent().find(p, end, " \t\r\n\f", 5, false);
+}
+
+size_t CharScanner::countNewlines(const char* p,
+                                  const char* end,
+                                  const char** last) {
+  return getCurrent().count(p, end, last);
+}
+
+CharScanner::Implementation CharScanner::getImplementation() {
+  return getCurrent().implementation;
+}
+
+bool CharScanner::setImplementation(Implementation implementation) {
+  if (!isSupported(implementation))
+    return false;
+  getCurrent() = getKernels(implementation);
+  return true;
+}
@@ -1,43 +1,146 @@
 #include "less/css/CssTokenizer.h"
 
+/**
+ * The character classes of the grammar at the top of CssTokenizer.h.
+ */
+enum CharClass {
+  // [_a-z]|{nonascii}
+  NMSTART = 1,
+  // [_a-z0-9-]|{nonascii}
+  NMCHAR = 2,
+  DIGIT = 4,
+  HEX = 8,
+  // [ \t\r\n\f]
+  WHITESPACE = 16,
+  // \n|\r|\f
+  NEWLINE = 32
+};
+
+static constexpr unsigned char classify(int c) {
+  return ((c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c >= 128)
+              ? NMSTART | NMCHAR
+              : 0) |
+         ((c >= '0' && c <= '9') ? NMCHAR | DIGIT | HEX : 0) |
+         (c == '-' ? NMCHAR : 0) |
+         (((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) ? HEX : 0) |
+         ((c == ' ' || c == '\t') ? WHITESPACE : 0) |
+         ((c == '\n' || c == '\r' || c == '\f') ? WHITESPACE | NEWLINE : 0);
+}
+
+#define CLASSES4(c) \
+  classify(c), classify(c + 1), classify(c + 2), classify(c + 3)
+#define CLASSES16(c) \
+  CLASSES4(c), CLASSES4(c + 4), CLASSES4(c + 8), CLASSES4(c + 12)
+#define CLASSES64(c) \
+  CLASSES16(c), CLASSES16(c + 16), CLASSES16(c + 32), CLASSES16(c + 48)
+
+/**
+ * The classes of each character, computed at compile time.
+ */
+static constexpr unsigned char charClasses[256] = {
+    CLASSES64(0), CLASSES64(64), CLASSES64(128), CLASSES64(192)};
+
+static inline bool isNMChar(char c) {
+  return (charClasses[(unsigned char)c] & NMCHAR) != 0;
+}
+
 CssTokenizer::CssTokenizer(istream& in, const char* source)
-    : in(&in), line(0), source(source) {
+    : line(0), source(source) {
+  streamInput = new StreamInputSource(in);
+  this->in = streamInput;
+  pos = end = tokenStart = NULL;
+
   currentToken.source = source;
   lastRead = 0;
   readChar();
   column = 0;
 }
 
+CssTokenizer::CssTokenizer(InputSource& in, const char* source)
+    : in(&in), streamInput(NULL), line(0), source(source) {
+  pos = end = tokenStart = NULL;
+
+  currentToken.source = source;
+  lastRead = 0;
+  readChar();
+  column = 0;
+}
+
+CssTokenizer::CssTokenizer(const char* source)
+    : in(NULL), streamInput(NULL), line(0), column(0), source(source) {
+  pos = end = tokenStart = NULL;
+
+  currentToken.source = source;
+  lastRead = 0;
+}
+
 CssTokenizer::~CssTokenizer() {
+  if (streamInput != NULL)
+    delete streamInput;
 }
 
 const char* CssTokenizer::getSource() {
   return source;
 }
 
-void CssTokenizer::readChar() {
-  if (in == NULL)
-    return;
+bool CssTokenizer::readBuffer() {
+  bool inToken = (tokenStart != NULL);
 
-  // Last char was a newline. Increment the line counter.
-  if (lastReadEq('\n')) {
-    line++;
-    column = 0;
-  } else
-    column++;
+  // the current block is about to be replaced; keep the part of the
+  // token that is in it.
+  if (inToken)
+    currentToken.append(tokenStart, end - tokenStart);
 
-  in->get(lastRead);
+  while (in->fill()) {
+    pos = in->getBegin();
+    end = in->getEnd();
+    if (pos != end) {
+      tokenStart = inToken ? pos : NULL;
+      return true;
+    }
+  }
+  pos = end = tokenStart = NULL;
+  return false;
+}
 
-  // check for end of file or escape key
-  if (in->eof() || lastRead == 27)
-    in = NULL;
-  else if (in->fail() || in->bad())
-    throw new IOException("Error reading input");
+void CssTokenizer::skipTo(const char* q) {
+  const char* last;
+  size_t newlines;
 
-  if (lastReadEq('\n') && column > 0)  // don't count newlines as chars
+  if (q == pos)
+    return;
+
+  // the characters that are read past are lastRead up to the one before
+  // the new lastRead.
+  newlines = CharScanner::countNewlines(pos - 1, q - 1, &last);
+  if (newlines == 0)
+    column += q - pos;
+  else {
+    line += newlines;
+    column = (q - 1) - (last + 1);
+  }
+
+  lastRead = q[-1];
+  pos = q;
+  // don't count newlines as chars
+  if (lastRead == '\n' && column > 0)
     column--;
 }
 
+void CssTokenizer::updateToken() {
+  const char* tokenEnd;
+
+  if (tokenStart == NULL)
+    return;
+
+  // lastRead is the first character after the token, unless the end
+  // of the input has been reached.
+  tokenEnd = (in == NULL) ? pos : pos - 1;
+  currentToken.append(tokenStart, tokenEnd - tokenStart);
+  tokenStart = tokenEnd;
+}
+
 Token::Type CssTokenizer::readNextToken() {
   if (in == NULL) {
     currentToken.type = Token::EOS;
@@ -47,11 +150,11 @@ Token::Type CssTokenizer::readNextToken() {
   currentToken.clear();
   currentToken.line = line;
   currentToken.column = column;
+  tokenStart = pos - 1;
 
   switch (lastRead) {
     case '@':
       currentToken.type = Token::ATKEYWORD;
-      currentToken.append(lastRead);
       readChar();
       if (!readIdent()) {
         currentToken.type = Token::OTHER;
@@ -60,7 +163,6 @@ Token::Type CssTokenizer::readNextToken() {
 
     case '#':
       currentToken.type = Token::HASH;
-      currentToken.append(lastRead);
       readChar();
       if (!readName()) {
         throw new ParseException(
@@ -69,7 +171,6 @@ Token::Type CssTokenizer::readNextToken() {
       break;
 
     case '-':
-      currentToken.append(lastRead);
       readChar();
       if (readNum(true)) {
         currentToken.type = Token::NUMBER;
@@ -81,10 +182,8 @@ Token::Type CssTokenizer::readNextToken() {
       break;
 
     case '~':
-      currentToken.append(lastRead);
       readChar();
       if (lastRead == '=') {
-        currentToken.append(lastRead);
         readChar();
         currentToken.type = Token::INCLUDES;
       } else
@@ -92,10 +191,8 @@ Token::Type CssTokenizer::readNextToken() {
       break;
 
     case '|':
-      currentToken.append(lastRead);
       readChar();
       if (lastRead == '=') {
-        currentToken.append(lastRead);
         readChar();
         currentToken.type = Token::DASHMATCH;
       } else
@@ -103,7 +200,6 @@ Token::Type CssTokenizer::readNextToken() {
       break;
 
     case '/':
-      currentToken.append(lastRead);
       readChar();
       if (readComment())
         currentToken.type = Token::COMMENT;
@@ -113,47 +209,38 @@ Token::Type CssTokenizer::readNextToken() {
 
     case ';':
       currentToken.type = Token::DELIMITER;
-      currentToken.append(lastRead);
       readChar();
       break;
     case ':':
       currentToken.type = Token::COLON;
-      currentToken.append(lastRead);
       readChar();
       break;
     case '{':
       currentToken.type = Token::BRACKET_OPEN;
-      currentToken.append(lastRead);
       readChar();
       break;
     case '}':
       currentToken.type = Token::BRACKET_CLOSED;
-      currentToken.append(lastRead);
       readChar();
       break;
     case '(':
       currentToken.type = Token::PAREN_OPEN;
-      currentToken.append(lastRead);
       readChar();
       break;
     case ')':
       currentToken.type = Token::PAREN_CLOSED;
-      currentToken.append(lastRead);
       readChar();
       break;
     case '[':
       currentToken.type = Token::BRACE_OPEN;
-      currentToken.append(lastRead);
       readChar();
       break;
     case ']':
       currentToken.type = Token::BRACE_CLOSED;
-      currentToken.append(lastRead);
       readChar();
       break;
 
     case '.':
-      currentToken.append(lastRead);
       readChar();
       if (readNum(false)) {
         currentToken.type = Token::NUMBER;
@@ -161,76 +248,114 @@ Token::Type CssTokenizer::readNextToken() {
       }
       break;
 
-    default:
-      if (readString())
-        currentToken.type = Token::STRING;
-      else if (readNum(true)) {
-        currentToken.type = Token::NUMBER;
-        readNumSuffix();
+    case '"':
+    case '\'':
+      readString();
+      currentToken.type = Token::STRING;
+      break;
 
-      } else if (readIdent()) {
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+      readNum(true);
+      currentToken.type = Token::NUMBER;
+      readNumSuffix();
+      break;
+
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+    case '\f':
+      currentToken.type = Token::WHITESPACE;
+      skipWhitespace();
+      break;
+
+    default:
+      if (readIdent()) {
         currentToken.type = Token::IDENTIFIER;
+        updateToken();
 
         if (currentToken == "url" && readUrl())
           currentToken.type = Token::URL;
         else if (currentToken == "u" && lastReadEq('+')) {
-          currentToken.append(lastRead);
           readChar();
           currentToken.type = Token::UNICODE_RANGE;
           readUnicodeRange();
         }
       } else if (readWhitespace()) {
+        // an escaped newline
         currentToken.type = Token::WHITESPACE;
-        while (readWhitespace()) {
-        };
+        skipWhitespace();
       } else {
-        currentToken.append(lastRead);
         readChar();
       }
       break;
   }
 
+  updateToken();
+  tokenStart = NULL;
+
+  // variable and function names are interned once here instead of on
+  // every lookup.
+  if (currentToken.type == Token::ATKEYWORD ||
+      (currentToken.type == Token::IDENTIFIER && lastReadEq('(')))
+    currentToken.setSymbol(Symbol(currentToken));
   return currentToken.type;
 }
 
 bool CssTokenizer::readIdent() {
   if (lastReadEq('-')) {
-    currentToken.append(lastRead);
     readChar();
   }
   if (!readNMStart())
     return false;
-  else
-    while (readNMChar()) {
-    }
+  readNMChars();
   return true;
 }
 
 bool CssTokenizer::readName() {
   if (!readNMChar())
     return false;
+  readNMChars();
+  return true;
+}
+
+void CssTokenizer::readNMChars() {
+  const char* q;
+
   while (readNMChar()) {
+    if (in == NULL || !isNMChar(lastRead))
+      continue;
+
+    // the name characters that follow in the block can be read in one
+    // go; they don't contain newlines.
+    for (q = pos; q != end && isNMChar(*q); q++) {
+    }
+    column += q - pos;
+    lastRead = q[-1];
+    pos = q;
   }
-  return true;
 }
 
 bool CssTokenizer::readNMStart() {
-  if (in == NULL)
-    return false;
-
-  if (lastReadEq('_') || lastReadInRange('a', 'z') ||
-      lastReadInRange('A', 'Z')) {
-    currentToken.append(lastRead);
+  if (lastReadIs(NMSTART)) {
     readChar();
     return true;
   } else
-    return (readNonAscii() || readEscape());
+    return readEscape();
 }
 bool CssTokenizer::readNonAscii() {
   if (in == NULL || lastRead >= 0)
     return false;
 
-  currentToken.append(lastRead);
   readChar();
   return true;
 }
@@ -238,13 +363,11 @@ bool CssTokenizer::readNonAscii() {
 bool CssTokenizer::readEscape() {
   if (!lastReadEq('\\'))
     return false;
-  currentToken.append(lastRead);
   readChar();
 
   if (readUnicode())
     return true;
-  else if (!lastReadEq('\n') && !lastReadEq('\r') && !lastReadEq('\f')) {
-    currentToken.append(lastRead);
+  else if (!lastReadIs(NEWLINE)) {
     readChar();
     return true;
   } else
@@ -257,7 +380,6 @@ bool CssTokenizer::readUnicode() {
 
   // [0-9a-f]{1,6}(\r\n|[ \n\r\t\f])?
   for (int i = 0; i < 6; i++) {
-    currentToken.append(lastRead);
     readChar();
     if (readWhitespace() || !lastReadIsHex())
       break;
@@ -266,32 +388,24 @@ bool CssTokenizer::readUnicode() {
 }
 
 bool CssTokenizer::readNMChar() {
-  if (in == NULL)
-    return false;
-
-  if (lastReadEq('_') || lastReadInRange('a', 'z') ||
-      lastReadInRange('A', 'Z') || lastReadIsDigit() || lastReadEq('-')) {
-    currentToken.append(lastRead);
+  if (lastReadIs(NMCHAR)) {
     readChar();
     return true;
   } else
-    return (readNonAscii() || readEscape());
+    return readEscape();
 }
 
 bool CssTokenizer::readNum(bool readDecimals) {
   if (!lastReadIsDigit())
     return false;
   while (lastReadIsDigit()) {
-    currentToken.append(lastRead);
     readChar();
   }
 
   if (readDecimals && lastReadEq('.')) {
-    currentToken.append(lastRead);
     readChar();
 
     while (lastReadIsDigit()) {
-      currentToken.append(lastRead);
       readChar();
     }
   }
@@ -301,7 +415,6 @@ bool CssTokenizer::readNum(bool readDecimals) {
 bool CssTokenizer::readNumSuffix() {
   if (lastRead == '%') {
     currentToken.type = Token::PERCENTAGE;
-    currentToken.append(lastRead);
     readChar();
     return true;
   } else if (readIdent()) {
@@ -316,15 +429,15 @@ bool CssTokenizer::readString() {
   if (!lastReadEq('"') && !lastReadEq('\''))
     return false;
   char delim = lastRead;
+  // the characters that end a run of plain characters in the string
+  const char stop[] = {delim, '\\', '\n', '\r', '\f', 27};
 
-  currentToken.append(lastRead);
   readChar();
   while (in != NULL) {
     if (lastReadEq(delim)) {
-      currentToken.append(lastRead);
       readChar();
       return true;
-    } else if (lastReadEq('\n') || lastReadEq('\r') || lastReadEq('\f')) {
+    } else if (lastReadIs(NEWLINE)) {
       throw new ParseException(
           "end of line", "end of string", line, column, source);
     } else if (lastReadEq('\\'))
@@ -332,7 +445,7 @@ bool CssTokenizer::readString() {
       // eats the '\'.
       readEscape() || readNewline();
     else {
-      currentToken.append(lastRead);
+      skipTo(CharScanner::findAny(pos, end, stop, sizeof(stop)));
       readChar();
     }
   }
@@ -343,15 +456,12 @@ bool CssTokenizer::readString() {
 
 bool CssTokenizer::readNewline() {
   if (lastReadEq('\r')) {
-    currentToken.append(lastRead);
     readChar();
     if (lastReadEq('\n')) {
-      currentToken.append(lastRead);
       readChar();
     }
     return true;
   } else if (lastReadEq('\n') || lastReadEq('\f')) {
-    currentToken.append(lastRead);
     readChar();
     return true;
   } else
@@ -359,28 +469,32 @@ bool CssTokenizer::readNewline() {
 }
 
 bool CssTokenizer::readWhitespace() {
-  if (lastReadEq(' ') || lastReadEq('\t') || lastReadEq('\r') ||
-      lastReadEq('\n') || lastReadEq('\f')) {
-    currentToken.append(lastRead);
+  if (lastReadIs(WHITESPACE)) {
     readChar();
     return true;
   } else
     return false;
 }
 
+void CssTokenizer::skipWhitespace() {
+  while (readWhitespace()) {
+    if (lastReadIs(WHITESPACE) && pos != end &&
+        (charClasses[(unsigned char)*pos] & WHITESPACE) != 0) {
+      skipTo(CharScanner::findNotWhitespace(pos + 1, end));
+    }
+  }
+}
+
 bool CssTokenizer::readUrl() {
   string urlchars = "!#$%&*-[]-~";
 
   if (!lastReadEq('('))
     return false;
-  currentToken.append(lastRead);
   readChar();
-  while (readWhitespace()) {
-  };
+  skipWhitespace();
 
   if (readString()) {
     if (lastReadEq(')')) {
-      currentToken.append(lastRead);
       readChar();
       return true;
     } else {
@@ -391,10 +505,8 @@ bool CssTokenizer::readUrl() {
 
   while (in != NULL) {
     if (readWhitespace() || lastReadEq(')')) {
-      while (readWhitespace()) {
-      };
+      skipWhitespace();
       if (lastReadEq(')')) {
-        currentToken.append(lastRead);
         readChar();
         return true;
       } else {
@@ -402,7 +514,6 @@ bool CssTokenizer::readUrl() {
             &lastRead, "end of url (')')", line, column, source);
       }
     } else if (in != NULL && urlchars.find(lastRead)) {
-      currentToken.append(lastRead);
       readChar();
     } else if (!readNonAscii() && !readEscape()) {
       throw new ParseException(
@@ -416,21 +527,18 @@ bool CssTokenizer::readUrl() {
 bool CssTokenizer::readComment() {
   if (!lastReadEq('*'))
     return false;
-  currentToken.append(lastRead);
   readChar();
   while (in != NULL) {
     if (lastReadEq('*')) {
-      currentToken.append(lastRead);
       readChar();
 
       if (lastReadEq('/')) {
-        currentToken.append(lastRead);
         readChar();
         return true;
       }
       continue;
     }
-    currentToken.append(lastRead);
+    skipTo(CharScanner::findAny(pos, end, "*\x1b", 2));
     readChar();
   }
   throw new ParseException(
@@ -444,7 +552,6 @@ bool CssTokenizer::readUnicodeRange() {
   for (int i = 0; i < 6; i++) {
     if (!lastReadIsHex())
       break;
-    currentToken.append(lastRead);
     readChar();
   }
   if (!lastReadEq('-'))
@@ -453,7 +560,6 @@ bool CssTokenizer::readUnicodeRange() {
   for (int i = 0; i < 6; i++) {
     if (!lastReadIsHex())
       break;
-    currentToken.append(lastRead);
     readChar();
   }
   return true;
@@ -473,10 +579,12 @@ bool CssTokenizer::lastReadEq(char c) {
 bool CssTokenizer::lastReadInRange(char c1, char c2) {
   return (in != NULL && lastRead >= c1 && lastRead <= c2);
 }
+bool CssTokenizer::lastReadIs(unsigned int classes) {
+  return (in != NULL && (charClasses[(unsigned char)lastRead] & classes) != 0);
+}
 bool CssTokenizer::lastReadIsDigit() {
-  return (in != NULL && lastReadInRange('0', '9'));
+  return lastReadIs(DIGIT);
 }
 bool CssTokenizer::lastReadIsHex() {
-  return (in != NULL && (lastReadIsDigit() || lastReadInRange('a', 'f') ||
-                         lastReadInRange('A', 'F')));
+  return lastReadIs(HEX);
 }
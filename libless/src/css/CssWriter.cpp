@@ -142,6 +142,11 @@ void CssWriter::writeDeclaration(const Token &property,
   writeValue(value);
 }
 
+void CssWriter::writeCss(const std::string &css, unsigned int column) {
+  out->write(css.data(), css.size());
+  this->column = column;
+}
+
 void CssWriter::writeDeclarationDeliminator() {
   writeStr(";", 1);
 }
@@ -0,0 +1,120 @@
+#include "less/css/InputSource.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+BufferInputSource::BufferInputSource(const char* data, size_t length)
+    : data(data), length(length), filled(false) {
+}
+
+BufferInputSource::BufferInputSource(const std::string& data)
+    : data(data.data()), length(data.size()), filled(false) {
+}
+
+bool BufferInputSource::fill() {
+  if (filled || length == 0)
+    return false;
+
+  begin = data;
+  end = data + length;
+  filled = true;
+  return true;
+}
+
+StreamInputSource::StreamInputSource(istream& in, size_t size)
+    : in(&in), size(size) {
+  buffer = new char[size];
+}
+
+StreamInputSource::~StreamInputSource() {
+  delete[] buffer;
+}
+
+bool StreamInputSource::fill() {
+  streamsize n;
+
+  if (in == NULL)
+    return false;
+
+  // block for the first character
+  if (!in->get(buffer[0])) {
+    if (in->bad() || !in->eof())
+      throw new IOException("Error reading input");
+    return false;
+  }
+
+  // then take what is available without blocking
+  n = in->readsome(buffer + 1, size - 1);
+  if (in->bad())
+    throw new IOException("Error reading input");
+
+  // readsome() sets eof when nothing is buffered; the next fill()
+  // detects the real end of the stream.
+  in->clear();
+
+  begin = buffer;
+  end = buffer + 1 + n;
+  return true;
+}
+
+FileInputSource::FileInputSource(const char* filename)
+    : map(NULL), mapLength(0), filled(false) {
+  struct stat st;
+  int fd = open(filename, O_RDONLY);
+
+  if (fd < 0)
+    throw new IOException("Error opening file");
+
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+      map = NULL;
+    else
+      mapLength = st.st_size;
+  }
+
+  if (map == NULL) {
+    try {
+      read(fd);
+    } catch (IOException* e) {
+      close(fd);
+      throw;
+    }
+  }
+  close(fd);
+}
+
+FileInputSource::~FileInputSource() {
+  if (map != NULL)
+    munmap(map, mapLength);
+}
+
+void FileInputSource::read(int fd) {
+  char buf[StreamInputSource::DEFAULT_BUFFER_SIZE];
+  ssize_t n;
+
+  while ((n = ::read(fd, buf, sizeof(buf))) != 0) {
+    if (n < 0)
+      throw new IOException("Error reading input");
+    contents.append(buf, n);
+  }
+}
+
+bool FileInputSource::fill() {
+  if (filled)
+    return false;
+  filled = true;
+
+  if (map != NULL) {
+    begin = (const char*)map;
+    end = begin + mapLength;
+  } else if (!contents.empty()) {
+    begin = contents.data();
+    end = begin + contents.size();
+  } else
+    return false;
+
+  return true;
+}
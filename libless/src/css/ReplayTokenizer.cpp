@@ -0,0 +1,26 @@
+#include "less/css/ReplayTokenizer.h"
+
+ReplayTokenizer::ReplayTokenizer(const TokenList& tokens, const char* source)
+    : CssTokenizer(source), it(tokens.begin()), tokensEnd(tokens.end()) {
+}
+
+ReplayTokenizer::ReplayTokenizer(TokenList::const_iterator begin,
+                                 TokenList::const_iterator end,
+                                 const char* source)
+    : CssTokenizer(source), it(begin), tokensEnd(end) {
+}
+
+ReplayTokenizer::~ReplayTokenizer() {
+}
+
+Token::Type ReplayTokenizer::readNextToken() {
+  // like CssTokenizer, the last token is kept at the end of the input
+  if (it == tokensEnd) {
+    currentToken.type = Token::EOS;
+    return Token::EOS;
+  }
+
+  currentToken = *it++;
+  currentToken.source = source;
+  return currentToken.type;
+}
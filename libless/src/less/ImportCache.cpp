@@ -0,0 +1,149 @@
+#include "less/less/ImportCache.h"
+#include "less/less/LessTokenizer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+ImportCache::ImportCache() : symbols(std::make_shared<SymbolTable>()) {
+}
+
+std::shared_ptr<const ImportCache::Entry> ImportCache::get(
+    const std::string& filename) {
+  struct stat st;
+  std::map<std::string, File>::iterator it;
+  std::shared_ptr<const Entry> previous;
+  std::shared_ptr<Entry> entry;
+  std::shared_ptr<SymbolTable> table;
+  std::string contents;
+  unsigned long long h;
+  char* resolved;
+  std::string path;
+
+  // the same relative name can refer to different files between
+  // compilations.
+  if ((resolved = realpath(filename.c_str(), NULL)) == NULL ||
+      stat(resolved, &st) != 0) {
+    free(resolved);
+    throw new IOException("Error opening file");
+  }
+  path = resolved;
+  free(resolved);
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // another thread is reading the file; wait for its result.
+    while (loading.count(path) > 0)
+      loaded.wait(lock);
+
+    it = files.find(path);
+    if (it != files.end()) {
+      if (it->second.size == st.st_size &&
+          it->second.mtime.tv_sec == st.st_mtim.tv_sec &&
+          it->second.mtime.tv_nsec == st.st_mtim.tv_nsec) {
+        return it->second.entry;
+      }
+      previous = it->second.entry;
+    }
+    table = symbols;
+    loading.insert(path);
+  }
+
+  // read and tokenize without holding the lock, so other files can be
+  // served in the meantime.
+  try {
+    read(path, contents);
+  } catch (IOException* e) {
+    std::lock_guard<std::mutex> lock(mutex);
+    loading.erase(path);
+    loaded.notify_all();
+    throw;
+  }
+  h = hash(contents);
+
+  if (previous == NULL || previous->symbols != table ||
+      previous->hash != h || previous->contents != contents) {
+    entry = std::make_shared<Entry>();
+    entry->path = path;
+    entry->hash = h;
+    entry->contents.swap(contents);
+    entry->symbols = table;
+    tokenize(*entry);
+    previous = entry;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  // an entry of a cleared cache is not kept.
+  if (table == symbols) {
+    File& file = files[path];
+    file.mtime = st.st_mtim;
+    file.size = st.st_size;
+    file.entry = previous;
+  }
+  loading.erase(path);
+  loaded.notify_all();
+  return previous;
+}
+
+void ImportCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  files.clear();
+  // entries that are still in use keep the old table.
+  symbols = std::make_shared<SymbolTable>();
+}
+
+size_t ImportCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return files.size();
+}
+
+std::shared_ptr<SymbolTable> ImportCache::getSymbols() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return symbols;
+}
+
+unsigned long long ImportCache::hash(const std::string& contents) {
+  // 64 bit FNV-1a
+  unsigned long long h = 14695981039346656037ULL;
+  std::string::const_iterator it;
+
+  for (it = contents.begin(); it != contents.end(); it++) {
+    h ^= (unsigned char)*it;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+void ImportCache::read(const std::string& filename, std::string& contents) {
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+  std::ostringstream buffer;
+
+  if (!in.good())
+    throw new IOException("Error opening file");
+
+  buffer << in.rdbuf();
+  if (in.bad())
+    throw new IOException("Error reading input");
+
+  contents = buffer.str();
+}
+
+void ImportCache::tokenize(Entry& entry) {
+  BufferInputSource in(entry.contents);
+  LessTokenizer tokenizer(in, entry.path.c_str());
+  SymbolTable::Scope scope(*entry.symbols);
+
+  entry.tokens.clear();
+  entry.tokenized = false;
+
+  try {
+    while (tokenizer.readNextToken() != Token::EOS)
+      entry.tokens.push_back(tokenizer.getToken());
+  } catch (ParseException* e) {
+    delete e;
+    entry.tokens.clear();
+    return;
+  }
+  entry.tokenized = true;
+}
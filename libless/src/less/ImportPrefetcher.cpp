@@ -0,0 +1,113 @@
+#include "less/less/ImportPrefetcher.h"
+#include "less/css/ParseException.h"
+#include "less/less/LessParser.h"
+
+/**
+ * Move it past whitespace and comments.
+ */
+static void skipWhitespace(TokenList::const_iterator &it,
+                           TokenList::const_iterator end) {
+  while (it != end &&
+         (it->type == Token::WHITESPACE || it->type == Token::COMMENT))
+    it++;
+}
+
+/**
+ * Read the directives and the uri of the import statement that starts
+ * at it, the @import keyword.
+ *
+ * @return false if the statement is not a valid import.
+ */
+static bool readImport(TokenList::const_iterator it,
+                       TokenList::const_iterator end,
+                       Token &uri,
+                       unsigned int &directive) {
+  directive = 0;
+
+  skipWhitespace(++it, end);
+  if (it != end && it->type == Token::PAREN_OPEN) {
+    do {
+      skipWhitespace(++it, end);
+      if (it == end)
+        return false;
+
+      try {
+        directive |= LessParser::parseImportDirective(*it);
+      } catch (ParseException *e) {
+        delete e;
+        return false;
+      }
+      skipWhitespace(++it, end);
+    } while (it != end && *it == ",");
+
+    if (it == end || it->type != Token::PAREN_CLOSED)
+      return false;
+    skipWhitespace(++it, end);
+  }
+
+  if (it == end || (it->type != Token::URL && it->type != Token::STRING))
+    return false;
+  uri = *it;
+  return true;
+}
+
+ImportPrefetcher::ImportPrefetcher(ImportCache &cache,
+                                   const std::list<const char *> *includePaths,
+                                   const Executor &executor)
+    : cache(cache), includePaths(includePaths), executor(executor),
+      running(0) {
+}
+
+ImportPrefetcher::~ImportPrefetcher() {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (running > 0)
+    finished.wait(lock);
+}
+
+void ImportPrefetcher::prefetch(const ImportCache::Entry &entry,
+                                const char *source) {
+  TokenList::const_iterator it;
+  Token uri;
+  unsigned int directive;
+  std::string filename;
+
+  if (!entry.tokenized)
+    return;
+
+  for (it = entry.tokens.begin(); it != entry.tokens.end(); it++) {
+    if (it->type != Token::ATKEYWORD || *it != "@import" ||
+        !readImport(it, entry.tokens.end(), uri, directive) ||
+        !LessParser::getImportPath(uri, directive))
+      continue;
+
+    uri.source = source;
+    filename.clear();
+    if (LessParser::findFile(uri, includePaths, filename))
+      fetch(filename);
+  }
+}
+
+void ImportPrefetcher::fetch(const std::string &filename) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!seen.insert(filename).second)
+      return;
+    running++;
+  }
+
+  executor([this, filename] {
+    std::shared_ptr<const ImportCache::Entry> entry;
+
+    try {
+      entry = cache.get(filename);
+      prefetch(*entry, filename.c_str());
+    } catch (IOException *e) {
+      delete e;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--running == 0)
+      finished.notify_all();
+  });
+}
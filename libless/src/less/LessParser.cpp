@@ -6,7 +6,32 @@
  * Only allows LessStylesheets
  */
 void LessParser::parseStylesheet(LessStylesheet &stylesheet) {
-  CssParser::parseStylesheet(stylesheet);
+  size_t imported;
+
+  if (dependencies == NULL) {
+    CssParser::parseStylesheet(stylesheet);
+    return;
+  }
+
+  // CssParser::parseStylesheet(), recording each statement
+  tokenizer->readNextToken();
+
+  skipWhitespace();
+  while (true) {
+    imported = sources.size();
+    if (!parseStatement(stylesheet) && !parseEmptyStatement())
+      break;
+
+    dependencies->addStatements(stylesheet,
+                                tokenizer->getSource(),
+                                std::next(sources.cbegin(), imported),
+                                sources.cend());
+    skipWhitespace();
+  }
+
+  if (tokenizer->getTokenType() != Token::EOS) {
+    throw new ParseException(tokenizer->getToken(), "end of input");
+  }
 }
 
 void LessParser::parseStylesheet(LessRuleset &ruleset) {
@@ -436,6 +461,7 @@ bool LessParser::parseDeclaration(TokenList &tokens,
     i++;
   
   d->getValue().insert(d->getValue().begin(), i, tokens.end());
+  d->foldValue();
 
   return true;
 }
@@ -603,7 +629,7 @@ bool LessParser::parseImportStatement(TokenList &statement,
   return parseImportStatement(statement, NULL, &ruleset);
 }
 
-unsigned int LessParser::parseImportDirective(Token &t) {
+unsigned int LessParser::parseImportDirective(const Token &t) {
   if (t.type != Token::IDENTIFIER)
     throw new ParseException(t, "an import directive.");
   if (t == "reference")
@@ -626,15 +652,9 @@ unsigned int LessParser::parseImportDirective(Token &t) {
                              "inline, less, css, once, multiple or optional");
 }
 
-bool LessParser::importFile(Token uri,
-                            LessStylesheet *stylesheet,
-                            LessRuleset *ruleset,
-                            unsigned int directive) {
+bool LessParser::getImportPath(Token &uri, unsigned int directive) {
   size_t pathend;
   size_t extension_pos;
-  std::list<const char *>::iterator i;
-  std::string relative_filename;
-  char *relative_filename_cpy;
   std::string extension;
 
   if (uri.type == Token::URL) {
@@ -666,8 +686,21 @@ bool LessParser::importFile(Token uri,
       (directive & IMPORT_CSS)) {
     return false;
   }
+  return true;
+}
+
+bool LessParser::importFile(Token uri,
+                            LessStylesheet *stylesheet,
+                            LessRuleset *ruleset,
+                            unsigned int directive) {
+  std::list<const char *>::iterator i;
+  std::string relative_filename;
+  char *relative_filename_cpy;
+
+  if (!getImportPath(uri, directive))
+    return false;
 
-  if (!findFile(uri, relative_filename)) {
+  if (!findFile(uri, includePaths, relative_filename)) {
     if (directive & IMPORT_OPTIONAL)
       return true;
     else {
@@ -684,23 +717,48 @@ bool LessParser::importFile(Token uri,
     }
   }
 
-  ifstream in(relative_filename.c_str());
-
   relative_filename_cpy = new char[relative_filename.length() + 1];
   std::strcpy(relative_filename_cpy, relative_filename.c_str());
 
-  sources.push_back(relative_filename_cpy);
-  LessTokenizer tokenizer(in, relative_filename_cpy);
+  if (importCache == NULL) {
+    FileInputSource in(relative_filename_cpy);
+    LessTokenizer tokenizer(in, relative_filename_cpy);
+    parseImport(tokenizer, stylesheet, ruleset, directive);
+
+  } else {
+    std::shared_ptr<const ImportCache::Entry> entry =
+        importCache->get(relative_filename);
+
+    if (dependencies != NULL)
+      dependencies->addFile(relative_filename_cpy, entry);
+
+    if (entry->tokenized) {
+      ReplayTokenizer tokenizer(entry->tokens, relative_filename_cpy);
+      parseImport(tokenizer, stylesheet, ruleset, directive);
+    } else {
+      BufferInputSource in(entry->contents);
+      LessTokenizer tokenizer(in, relative_filename_cpy);
+      parseImport(tokenizer, stylesheet, ruleset, directive);
+    }
+  }
+  return true;
+}
+
+void LessParser::parseImport(CssTokenizer &tokenizer,
+                             LessStylesheet *stylesheet,
+                             LessRuleset *ruleset,
+                             unsigned int directive) {
+  sources.push_back(tokenizer.getSource());
   LessParser parser(tokenizer, sources, (directive & IMPORT_REFERENCE));
 
   parser.includePaths = includePaths;
+  parser.importCache = importCache;
+  parser.dependencies = dependencies;
 
   if (stylesheet != NULL)
     parser.parseStylesheet(*stylesheet);
   else
     parser.parseStylesheet(*ruleset);
-  in.close();
-  return true;
 }
 
 bool LessParser::importFile(Token uri,
@@ -714,11 +772,13 @@ bool LessParser::importFile(Token uri,
   return importFile(uri, NULL, &ruleset, directive);
 }
 
-bool LessParser::findFile(Token &uri, std::string &filename) {
-  ifstream *in;
+bool LessParser::findFile(const Token &uri,
+                          const std::list<const char *> *includePaths,
+                          std::string &filename) {
+  ifstream in;
   size_t pos;
   std::string source;
-  std::list<const char *>::iterator i;
+  std::list<const char *>::const_iterator i;
 
   source = uri.source;
   pos = source.find_last_of("/\\");
@@ -730,11 +790,12 @@ bool LessParser::findFile(Token &uri, std::string &filename) {
   }
   filename.append(uri);
 
-  in = new ifstream(filename.c_str());
-  if (in->good()) {
-    in->close();
+  in.open(filename.c_str());
+  if (in.good()) {
+    in.close();
     return true;
   }
+  in.clear();
 
   if (includePaths != NULL) {
     for (i = includePaths->begin(); i != includePaths->end(); i++) {
@@ -743,11 +804,12 @@ bool LessParser::findFile(Token &uri, std::string &filename) {
       filename.append((*i));
       filename.append(uri);
 
-      in = new ifstream(filename.c_str());
-      if (in->good()) {
-        in->close();
+      in.open(filename.c_str());
+      if (in.good()) {
+        in.close();
         return true;
       }
+      in.clear();
     }
   }
   return false;
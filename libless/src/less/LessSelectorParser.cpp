@@ -44,6 +44,9 @@ bool LessSelectorParser::parse(TokenList& tokens,
 
         parseConditions(*it, offset, selector);
       }
+      // the arguments and conditions may have been erased up to the end
+      if (offset == (*it).end())
+        break;
     }
     (*it).trim();
   }
@@ -59,15 +62,17 @@ bool LessSelectorParser::parseExtension(TokenList &tokens,
   Extension extension;
   TokenList target, ext;
   
-  if ((*it).type != Token::COLON ||
-      (*++it).type != Token::IDENTIFIER ||
+  if (it == tokens.end() ||
+      (*it).type != Token::COLON ||
+      ++it == tokens.end() ||
+      (*it).type != Token::IDENTIFIER ||
       (*it) != "extend" ||
-      (*++it).type != Token::PAREN_OPEN)
+      ++it == tokens.end() ||
+      (*it).type != Token::PAREN_OPEN)
     return false;
   
   it++;
-  tokens.erase(offset, it);
-  offset = it;
+  it = offset = tokens.erase(offset, it);
   
   for (; it != tokens.end() && parentheses > 0; it++) {
     if ((*it).type == Token::PAREN_OPEN)
@@ -82,8 +87,8 @@ bool LessSelectorParser::parseExtension(TokenList &tokens,
   }
   it--;
   
-  target.splice(target.begin(), tokens, offset, it);
-  offset = it;
+  target.insert(target.begin(), offset, it);
+  it = offset = tokens.erase(offset, it);
   ext.insert(ext.begin(), tokens.begin(), offset);
     
   if (!target.empty() && target.back() == "all") {
@@ -95,8 +100,7 @@ bool LessSelectorParser::parseExtension(TokenList &tokens,
   selectorParser.parse(ext, extension.getExtension());
   s.addExtension(extension);
 
-  offset++;
-  tokens.erase(it);
+  offset = tokens.erase(it);
   return true;
 }
 
@@ -121,7 +125,7 @@ bool LessSelectorParser::isArguments(TokenList &selector,
     it++;
   }
   
-  if ((*it).type != Token::PAREN_CLOSED)
+  if (it == selector.end() || (*it).type != Token::PAREN_CLOSED)
     return false;
   it++;
   
@@ -182,8 +186,7 @@ bool LessSelectorParser::parseArguments(TokenList &selector,
     return false;
   } else {
     it++;
-    selector.erase(offset, it);
-    offset = it;
+    offset = selector.erase(offset, it);
     return true;
   }
 }
@@ -262,7 +265,8 @@ bool LessSelectorParser::parseConditions(TokenList &selector,
       it++;
     }
     
-    condition.splice(condition.begin(), selector, offset, it);
+    condition.insert(condition.begin(), offset, it);
+    it = selector.erase(offset, it);
     condition.trim();
     s.addCondition(condition);
     condition.clear();
@@ -7,10 +7,9 @@ bool LessTokenizer::readComment() {
   if (!lastReadEq('/'))
     return CssTokenizer::readComment();
 
-  currentToken.append(lastRead);
   readChar();
   while (in != NULL && !lastReadEq('\n')) {
-    currentToken.append(lastRead);
+    skipTo(CharScanner::findAny(pos, end, "\n\x1b", 2));
     readChar();
   }
   return true;
@@ -0,0 +1,197 @@
+#include "less/less/ParallelParser.h"
+#include "less/css/ReplayTokenizer.h"
+#include "less/less/LessParser.h"
+#include "less/SymbolTable.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+/**
+ * The chunks of one parse, shared with the tasks that parse them. Tasks
+ * can run after the parse returned, when all chunks were taken.
+ */
+struct ParseState {
+  const TokenList *tokens;
+  const char *source;
+  std::vector<size_t> chunks;
+  std::vector<Arena *> arenas;
+  // the symbol table of the calling thread, or NULL
+  SymbolTable *symbols;
+  std::vector<LessStylesheet *> stylesheets;
+
+  // the next chunk to parse
+  std::atomic<size_t> next;
+
+  std::mutex mutex;
+  std::condition_variable finished;
+  size_t done;
+  bool failed;
+
+  ParseState() : symbols(NULL), next(0), done(0), failed(false) {
+  }
+
+  /**
+   * Parse chunks until none are left.
+   */
+  void run();
+};
+
+void ParseState::run() {
+  size_t i, end;
+  LessStylesheet *stylesheet;
+  bool ok;
+
+  while ((i = next++) < chunks.size()) {
+    end = (i + 1 < chunks.size()) ? chunks[i + 1] : tokens->size();
+    ok = true;
+
+    {
+      std::unique_ptr<Arena::Scope> scope(
+          arenas[i] != NULL ? new Arena::Scope(*arenas[i]) : NULL);
+      std::unique_ptr<SymbolTable::Scope> symbolScope(
+          symbols != NULL ? new SymbolTable::Scope(*symbols) : NULL);
+      ReplayTokenizer tokenizer(tokens->begin() + chunks[i],
+                                tokens->begin() + end,
+                                source);
+      // there are no imports, so no files are added
+      std::list<const char *> sources;
+      LessParser parser(tokenizer, sources);
+
+      stylesheet = new LessStylesheet();
+      try {
+        parser.parseStylesheet(*stylesheet);
+      } catch (std::exception *e) {
+        delete e;
+        ok = false;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stylesheets[i] = stylesheet;
+    if (!ok)
+      failed = true;
+    if (++done == chunks.size())
+      finished.notify_all();
+  }
+}
+
+ParallelParser::ParallelParser(const Executor &executor, size_t chunkSize)
+    : executor(executor), chunkSize(chunkSize) {
+}
+
+ParallelParser::~ParallelParser() {
+  std::vector<Arena *>::iterator it;
+
+  for (it = arenas.begin(); it != arenas.end(); it++)
+    delete *it;
+}
+
+bool ParallelParser::split(const TokenList &tokens,
+                           size_t chunkSize,
+                           std::vector<size_t> &chunks) {
+  TokenList::const_iterator it;
+  // open blocks and parentheses
+  unsigned int depth = 0;
+  size_t start = 0;
+  bool end;
+
+  chunks.clear();
+  chunks.push_back(0);
+
+  for (it = tokens.begin(); it != tokens.end(); it++) {
+    end = false;
+
+    switch (it->type) {
+      case Token::ATKEYWORD:
+        if (*it == "@import")
+          return false;
+        break;
+
+      case Token::OTHER:
+        // skip the braces of an interpolation, @{name}
+        if (*it == "@" && it + 1 != tokens.end() &&
+            (it + 1)->type == Token::BRACKET_OPEN) {
+          while (it + 1 != tokens.end() &&
+                 it->type != Token::BRACKET_CLOSED)
+            it++;
+        }
+        break;
+
+      case Token::BRACKET_OPEN:
+      case Token::PAREN_OPEN:
+        depth++;
+        break;
+
+      case Token::BRACKET_CLOSED:
+        end = (depth == 1);
+        // fall through
+      case Token::PAREN_CLOSED:
+        if (depth > 0)
+          depth--;
+        break;
+
+      case Token::DELIMITER:
+        end = (depth == 0);
+        break;
+
+      default:
+        break;
+    }
+
+    if (end && (size_t)(it - tokens.begin()) + 1 - start >= chunkSize) {
+      // a block can be followed by a ';'
+      while (it + 1 != tokens.end() &&
+             ((it + 1)->type == Token::WHITESPACE ||
+              (it + 1)->type == Token::DELIMITER))
+        it++;
+      start = it - tokens.begin() + 1;
+      if (start < tokens.size())
+        chunks.push_back(start);
+    }
+  }
+  return chunks.size() > 1;
+}
+
+bool ParallelParser::parse(const TokenList &tokens,
+                           const char *source,
+                           LessStylesheet &stylesheet) {
+  std::shared_ptr<ParseState> state = std::make_shared<ParseState>();
+  size_t i;
+  bool parsed;
+
+  if (!split(tokens, chunkSize, state->chunks))
+    return false;
+
+  state->tokens = &tokens;
+  state->source = source;
+  state->symbols = SymbolTable::getCurrent();
+  state->stylesheets.resize(state->chunks.size(), NULL);
+  for (i = 0; i < state->chunks.size(); i++) {
+    if (Arena::getCurrent() != NULL) {
+      arenas.push_back(new Arena());
+      state->arenas.push_back(arenas.back());
+    } else
+      state->arenas.push_back(NULL);
+  }
+
+  for (i = 1; i < state->chunks.size(); i++)
+    executor([state] { state->run(); });
+  state->run();
+
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state] {
+      return state->done == state->chunks.size();
+    });
+  }
+
+  parsed = !state->failed;
+  for (i = 0; i < state->stylesheets.size(); i++) {
+    if (parsed)
+      stylesheet.splice(*state->stylesheets[i]);
+    delete state->stylesheets[i];
+  }
+  return parsed;
+}
@@ -25,10 +25,7 @@ void Closure::getFunctions(std::list<const Function*>& functionList,
                            const Mixin& mixin,
                            TokenList::const_iterator offset,
                            const ProcessingContext &context) const {
-  const std::list<LessRuleset*>& nestedRules = ruleset->getNestedRules();
-  const std::list<Closure*> *closures = context.getClosures(ruleset);
-  std::list<LessRuleset*>::const_iterator r_it;
-  std::list<Closure*>::const_iterator c_it;
+  const MixinIndex *closures = context.getClosures(ruleset);
   TokenList::const_iterator offset2;
 
   offset2 = getLessSelector().walk(offset, mixin.name.end());
@@ -45,14 +42,10 @@ void Closure::getFunctions(std::list<const Function*>& functionList,
     if (offset2 == mixin.name.end()) {
       functionList.push_back(this);
     } else {
-      for (r_it = nestedRules.begin(); r_it != nestedRules.end(); r_it++) {
-        (*r_it)->getFunctions(functionList, mixin, offset2, context);
-      }
-      if (closures != NULL) {
-        for (c_it = closures->begin(); c_it != closures->end(); c_it++) {
-          (*c_it)->getFunctions(functionList, mixin, offset2, context);
-        }
-      }
+      ruleset->getNestedRuleIndex().getFunctions(
+          functionList, mixin, offset2, NULL, context);
+      if (closures != NULL)
+        closures->getFunctions(functionList, mixin, offset2, NULL, context);
     }
   }
 }
@@ -61,7 +54,7 @@ const LessSelector &Closure::getLessSelector() const {
   return ruleset->getLessSelector();
 }
 
-const TokenList* Closure::getVariable(const std::string& key,
+const TokenList* Closure::getVariable(const Symbol& key,
                                       const ProcessingContext &context) const {
   const TokenList* t;
 
@@ -70,6 +63,14 @@ const TokenList* Closure::getVariable(const std::string& key,
   return this->stack->getVariable(key, context);  
 }
 
+const TokenList* Closure::getLocalVariable(const Symbol& key) const {
+  return ruleset->getLocalVariable(key);
+}
+
+const Function* Closure::getParentScope() const {
+  return NULL;
+}
+
 void Closure::getLocalFunctions(std::list<const Function*>& functionList,
                                 const Mixin& mixin,
                                 const ProcessingContext &context) const {
@@ -0,0 +1,258 @@
+#include "less/lessstylesheet/DependencyGraph.h"
+#include "less/lessstylesheet/LessStylesheet.h"
+#include "less/lessstylesheet/ProcessingContext.h"
+#include "less/stylesheet/StylesheetStatement.h"
+
+bool Dependencies::addNames(const TokenList &tokens) {
+  TokenList::const_iterator it, next;
+
+  for (it = tokens.begin(); it != tokens.end(); it++) {
+    next = it + 1;
+
+    if (it->type == Token::ATKEYWORD) {
+      variables.insert(*it);
+    } else if (it->type == Token::HASH) {
+      mixins.insert(*it);
+    } else if (it->type == Token::OTHER && next != tokens.end()) {
+      if (*it == "." && next->type == Token::IDENTIFIER)
+        mixins.insert("." + *next);
+      else if (*it == "@" && next->type == Token::BRACKET_OPEN)
+        return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns true if a and b have an element in common.
+ */
+static bool intersects(const std::set<std::string> &a,
+                       const std::set<std::string> &b) {
+  std::set<std::string>::const_iterator it;
+
+  if (a.size() > b.size())
+    return intersects(b, a);
+
+  for (it = a.begin(); it != a.end(); it++) {
+    if (b.count(*it) > 0)
+      return true;
+  }
+  return false;
+}
+
+DependencyGraph::DependencyGraph()
+    : stylesheet(NULL),
+      extensions(false),
+      previousExtensions(false),
+      reused(0) {
+}
+
+void DependencyGraph::begin(const LessStylesheet &stylesheet) {
+  this->stylesheet = &stylesheet;
+  nodes.clear();
+  files.clear();
+  ordinals.clear();
+  extensions = false;
+  reused = 0;
+}
+
+const LessStylesheet *DependencyGraph::getStylesheet() const {
+  return stylesheet;
+}
+
+void DependencyGraph::addFile(
+    const char *source,
+    const std::shared_ptr<const ImportCache::Entry> &entry) {
+  File file;
+
+  file.name = source;
+  file.entry = entry;
+  files.push_back(file);
+}
+
+void DependencyGraph::addStatements(
+    const Stylesheet &stylesheet,
+    const char *origin,
+    std::list<const char *>::const_iterator imported,
+    std::list<const char *>::const_iterator end) {
+  size_t added;
+  Node node;
+
+  if (&stylesheet != this->stylesheet)
+    return;
+
+  // statements of imported files were added by the parsers of those
+  // files.
+  added = stylesheet.getStatements().size() - nodes.size();
+
+  node.origin = origin;
+  for (; imported != end; imported++)
+    node.sources.insert(*imported);
+
+  for (; added > 0; added--) {
+    node.ordinal = ordinals[node.origin]++;
+    nodes.push_back(node);
+  }
+}
+
+bool DependencyGraph::getChanges(std::set<std::string> &changed,
+                                 Dependencies &names) const {
+  std::vector<File>::const_iterator it, prev;
+
+  if (previousExtensions || files.size() != previousFiles.size())
+    return false;
+
+  for (it = files.begin(), prev = previousFiles.begin(); it != files.end();
+       it++, prev++) {
+    if (it->name != prev->name)
+      return false;
+
+    if (it->entry != prev->entry && it->entry->hash != prev->entry->hash) {
+      if (!it->entry->tokenized || !prev->entry->tokenized ||
+          !names.addNames(it->entry->tokens) ||
+          !names.addNames(prev->entry->tokens))
+        return false;
+      changed.insert(it->name);
+    }
+  }
+  return true;
+}
+
+bool DependencyGraph::isAffected(const Node &node,
+                                 const std::set<std::string> &changed,
+                                 const Dependencies &names) const {
+  // a comment at the start of the css depends on the column it was
+  // written at.
+  if (node.dependencies.sideEffects ||
+      (!node.css.empty() && (node.css[0] == '\n' || node.css[0] == '/')))
+    return true;
+
+  return changed.count(node.origin) > 0 ||
+         intersects(node.sources, changed) ||
+         intersects(node.dependencies.variables, names.variables) ||
+         intersects(node.dependencies.mixins, names.mixins);
+}
+
+void DependencyGraph::processNode(const StylesheetStatement &statement,
+                                  Node &node,
+                                  Stylesheet &css,
+                                  ProcessingContext &context) {
+  node.reused = false;
+  node.dependencies = Dependencies();
+  node.cssBegin = css.getStatements().size();
+
+  context.setDependencies(&node.dependencies);
+  if (!node.reference)
+    statement.process(css, &context);
+  context.setDependencies(NULL);
+
+  node.cssEnd = css.getStatements().size();
+}
+
+void DependencyGraph::process(Stylesheet &css, ProcessingContext &context) {
+  std::list<StylesheetStatement *>::const_iterator it;
+  std::vector<Node>::iterator node;
+  std::map<std::pair<std::string, unsigned int>, const Node *> last;
+  std::map<std::pair<std::string, unsigned int>, const Node *>::iterator
+      old;
+  std::set<std::string> changed;
+  Dependencies names;
+  bool full;
+  const std::list<Extension> *scope;
+  size_t i;
+
+  // the statements were not recorded by the parser
+  if (nodes.size() != stylesheet->getStatements().size()) {
+    nodes.assign(stylesheet->getStatements().size(), Node());
+    for (i = 0; i < nodes.size(); i++)
+      nodes[i].ordinal = i;
+    full = true;
+  } else
+    full = !getChanges(changed, names);
+
+  if (!full) {
+    for (node = previous.begin(); node != previous.end(); node++)
+      last[std::make_pair(node->origin, node->ordinal)] = &*node;
+  }
+
+  reused = 0;
+  for (it = stylesheet->getStatements().begin(), node = nodes.begin();
+       it != stylesheet->getStatements().end() && node != nodes.end();
+       it++, node++) {
+    node->reference = (*it)->isReference();
+
+    if (!full &&
+        (old = last.find(std::make_pair(node->origin, node->ordinal))) !=
+            last.end() &&
+        old->second->reference == node->reference &&
+        !isAffected(*old->second, changed, names)) {
+      node->reused = true;
+      node->dependencies = old->second->dependencies;
+      node->css = old->second->css;
+      node->column = old->second->column;
+      node->newline = old->second->newline;
+      reused++;
+    } else
+      processNode(**it, *node, css, context);
+  }
+
+  // an extension can change the selectors of any statement, so the
+  // statements that were skipped are processed after all. Their output
+  // is written in the order of the statements, not of the css.
+  scope = context.getExtensions();
+  if (scope != NULL && !scope->empty()) {
+    extensions = true;
+    for (it = stylesheet->getStatements().begin(), node = nodes.begin();
+         it != stylesheet->getStatements().end() && node != nodes.end();
+         it++, node++) {
+      if (node->reused)
+        processNode(**it, *node, css, context);
+    }
+    reused = 0;
+  }
+}
+
+void DependencyGraph::write(const Stylesheet &css,
+                            CssWriter &writer,
+                            std::ostringstream &out) {
+  std::vector<StylesheetStatement *> statements(css.getStatements().begin(),
+                                                css.getStatements().end());
+  std::vector<Node>::iterator node;
+  std::vector<size_t> offsets;
+  std::string text;
+  unsigned int column;
+  size_t i;
+
+  for (node = nodes.begin(); node != nodes.end(); node++) {
+    column = writer.getColumn();
+    offsets.push_back(out.tellp());
+
+    if (node->reused) {
+      writer.writeCss(node->css,
+                      node->newline ? node->column
+                                    : column + node->css.size());
+    } else {
+      for (i = node->cssBegin; i < node->cssEnd; i++)
+        statements[i]->write(writer);
+
+      node->column = writer.getColumn();
+      node->newline =
+          node->column < column + ((size_t)out.tellp() - offsets.back());
+    }
+  }
+  offsets.push_back(out.tellp());
+
+  text = out.str();
+  for (node = nodes.begin(), i = 0; node != nodes.end(); node++, i++) {
+    if (!node->reused)
+      node->css = text.substr(offsets[i], offsets[i + 1] - offsets[i]);
+  }
+
+  previous.swap(nodes);
+  previousFiles.swap(files);
+  previousExtensions = extensions;
+}
+
+unsigned int DependencyGraph::getReused() const {
+  return reused;
+}
@@ -1,6 +1,17 @@
 #include "less/lessstylesheet/LessDeclaration.h"
 #include "less/lessstylesheet/LessRuleset.h"
 
+LessDeclaration::LessDeclaration()
+    : lessRuleset(NULL),
+      compiledValue(NULL),
+      processed(false),
+      folded(false) {
+}
+
+LessDeclaration::~LessDeclaration() {
+  delete compiledValue;
+}
+
 void LessDeclaration::setLessRuleset(LessRuleset &r) {
   lessRuleset = &r;
 }
@@ -8,14 +19,39 @@ LessRuleset *LessDeclaration::getLessRuleset() {
   return lessRuleset;
 }
 
+void LessDeclaration::foldValue() {
+  ValueProcessor processor;
+
+  if (!folded && processor.isStatic(value))
+    folded = processor.processStatic(value);
+}
 
 void LessDeclaration::process(Ruleset &r, void* context) const {
   Declaration *d = r.createDeclaration();
+  ValueProcessor processor;
+
   d->setProperty(property);
-  d->setValue(value);
 
   ((ProcessingContext*)context)->interpolate(d->getProperty());
-  ((ProcessingContext*)context)->processValue(d->getValue());
+
+  if (folded) {
+    d->setValue(value);
+
+  } else {
+    if (compiledValue == NULL && processed) {
+      compiledValue = new CompiledValue(value);
+      processor.compileValue(*compiledValue);
+    }
+    processed = true;
+
+    if (compiledValue != NULL) {
+      ((ProcessingContext*)context)->processValue(*compiledValue,
+                                                  d->getValue());
+    } else {
+      d->setValue(value);
+      ((ProcessingContext*)context)->processValue(d->getValue());
+    }
+  }
 
   // If the `important` flag is set, append '!important'
   if(((ProcessingContext*)context)->isImportant()) {
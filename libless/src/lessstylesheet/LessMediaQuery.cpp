@@ -20,6 +20,11 @@ const LessStylesheet &LessMediaQuery::getLessStylesheet() const {
   return *parent;
 }
 
+void LessMediaQuery::setStylesheet(Stylesheet *s) {
+  StylesheetStatement::setStylesheet(s);
+  parent = (const LessStylesheet *)s;
+}
+
 void LessMediaQuery::getFunctions(std::list<const Function *> &functionList,
                                   const Mixin &mixin,
                                   const ProcessingContext &context) const {
@@ -27,7 +32,7 @@ void LessMediaQuery::getFunctions(std::list<const Function *> &functionList,
   getLessStylesheet().getFunctions(functionList, mixin, context);
 }
 
-const TokenList *LessMediaQuery::getVariable(const std::string &key,
+const TokenList *LessMediaQuery::getVariable(const Symbol &key,
                                              const ProcessingContext &context) const {
   const TokenList *t = LessStylesheet::getVariable(key, context);
   if (t == NULL)
@@ -80,6 +80,7 @@ LessRuleset* LessRuleset::createNestedRule(LessSelector& selector) {
   LessRuleset* r = new LessRuleset(selector, *this);
 
   nestedRules.push_back(r);
+  nestedRuleIndex.add(*r);
   return r;
 }
 
@@ -92,15 +93,19 @@ MediaQueryRuleset* LessRuleset::createMediaQuery(TokenList &selector) {
 
 void LessRuleset::deleteNestedRule(LessRuleset& ruleset) {
   nestedRules.remove(&ruleset);
+  nestedRuleIndex.remove(ruleset);
   delete &ruleset;
 }
 
 const std::list<LessRuleset*>& LessRuleset::getNestedRules() const {
   return nestedRules;
 }
+const MixinIndex& LessRuleset::getNestedRuleIndex() const {
+  return nestedRuleIndex;
+}
 
 void LessRuleset::putVariable(const std::string& key, const TokenList& value) {
-  variables[key] = value;
+  variables[Symbol(key)] = value;
 }
 
 VariableMap& LessRuleset::getVariables() {
@@ -122,6 +127,11 @@ void LessRuleset::setLessStylesheet(const LessStylesheet& s) {
   lessStylesheet = &s;
 }
 
+void LessRuleset::setStylesheet(Stylesheet* s) {
+  Ruleset::setStylesheet(s);
+  lessStylesheet = (const LessStylesheet*)s;
+}
+
 const LessStylesheet* LessRuleset::getLessStylesheet() const {
   if (lessStylesheet != NULL)
     return lessStylesheet;
@@ -262,12 +272,12 @@ void LessRuleset::processStatements(Stylesheet& target,
   insertNestedRules(target, NULL, *(ProcessingContext*)context);
 }
 
-const TokenList* LessRuleset::getVariable(const std::string& key,
+const TokenList* LessRuleset::getVariable(const Symbol& key,
                                           const ProcessingContext &context) const {
   const TokenList* t;
   const VariableMap* m;
 
-  if ((t = getVariable(key)) != NULL)
+  if ((t = variables.getVariable(key)) != NULL)
     return t;
 
   if ((m = context.getStackArguments(this)) != NULL) {
@@ -284,13 +294,19 @@ const TokenList* LessRuleset::getVariable(const std::string& key,
     return getLessStylesheet()->getVariable(key, context);
 }
 
+const TokenList* LessRuleset::getLocalVariable(const Symbol& key) const {
+  return variables.getVariable(key);
+}
+
+const Function* LessRuleset::getParentScope() const {
+  return parent;
+}
+
 void LessRuleset::getFunctions(list<const Function*>& functionList,
                                const Mixin& mixin,
                                TokenList::const_iterator offset,
                                const ProcessingContext &context) const {
-  std::list<LessRuleset*>::const_iterator r_it;
-  const std::list<Closure*>* closures;
-  std::list<Closure*>::const_iterator c_it;
+  const MixinIndex* closures;
   TokenList::const_iterator offset2;
   
   offset2 = getSelector().walk(offset, mixin.name.end());
@@ -309,16 +325,11 @@ void LessRuleset::getFunctions(list<const Function*>& functionList,
     }
   } else {
     if (!selector->needsArguments() && matchConditions(context)) {
-      
-      for (r_it = nestedRules.begin(); r_it != nestedRules.end(); r_it++) {
-        (*r_it)->getFunctions(functionList, mixin, offset2, context);
-      }
+      nestedRuleIndex.getFunctions(functionList, mixin, offset2, NULL,
+                                   context);
       closures = context.getClosures(this);
-      if (closures != NULL) {
-        for (c_it = closures->begin(); c_it != closures->end(); c_it++) {
-          (*c_it)->getFunctions(functionList, mixin, offset2, context);
-        }
-      }
+      if (closures != NULL)
+        closures->getFunctions(functionList, mixin, offset2, NULL, context);
     }
   }
 }
@@ -333,21 +344,15 @@ void LessRuleset::getLocalFunctions(std::list<const Function*>& functionList,
                                     const Mixin& mixin,
                                     const LessRuleset* exclude,
                                     const ProcessingContext &context) const {
-  std::list<LessRuleset*>::const_iterator r_it;
-  const std::list<Closure*>* closures;
-  std::list<Closure*>::const_iterator c_it;
+  const MixinIndex* closures;
+
+  nestedRuleIndex.getFunctions(functionList, mixin, mixin.name.begin(),
+                               exclude, context);
 
-  for (r_it = nestedRules.begin(); r_it != nestedRules.end(); r_it++) {
-    if ((*r_it) != exclude) {
-      (*r_it)->getFunctions(functionList, mixin, mixin.name.begin(), context);
-    }
-  }
-  
   closures = context.getClosures(this);
   if (closures != NULL) {
-    for (c_it = closures->begin(); c_it != closures->end(); c_it++) {
-      (*c_it)->getFunctions(functionList, mixin, mixin.name.begin(), context);
-    }
+    closures->getFunctions(functionList, mixin, mixin.name.begin(), NULL,
+                           context);
   }
   
   if (!functionList.empty())
@@ -384,8 +389,9 @@ void LessRuleset::addClosures(ProcessingContext& context) const {
 
 bool LessRuleset::matchConditions(const ProcessingContext& context,
                                   bool defaultVal) const {
-  const std::list<TokenList>& conditions = selector->getConditions();
-  std::list<TokenList>::const_iterator it;
+  const std::list<Condition>& conditions =
+      selector->getCompiledConditions();
+  std::list<Condition>::const_iterator it;
 
   if (conditions.empty())
     return true;
@@ -420,7 +426,7 @@ bool LessRuleset::putArguments(MixinArguments& args, VariableMap& scope) const {
     if (variable == NULL || variable->empty())
       return false;
 
-    scope.insert(pair<std::string, TokenList>(*pit, *variable));
+    scope.insert(Symbol(*pit), *variable);
 
     argsCombined.insert(argsCombined.end(), variable->begin(), variable->end());
     argsCombined.push_back(Token::BUILTIN_SPACE);
@@ -436,10 +442,9 @@ bool LessRuleset::putArguments(MixinArguments& args, VariableMap& scope) const {
     }
 
     restVar.trim();
-    scope.insert(
-        pair<std::string, TokenList>(selector->getRestIdentifier(), restVar));
+    scope.insert(Symbol(selector->getRestIdentifier()), restVar);
   }
 
-  scope.insert(pair<std::string, TokenList>("@arguments", argsCombined));
+  scope.insert(Symbol("@arguments"), argsCombined);
   return true;
 }
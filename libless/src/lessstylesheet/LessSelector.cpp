@@ -1,8 +1,10 @@
 #include "less/lessstylesheet/LessRuleset.h"
+#include "less/value/ValueProcessor.h"
 
 LessSelector::LessSelector(): Selector() {
   _unlimitedArguments = false;
   _needsArguments = false;
+  _usesDefault = false;
 }
 LessSelector::~LessSelector() {
 }
@@ -26,6 +28,12 @@ const std::list<std::string> &LessSelector::getParameters() const {
 const std::list<TokenList> &LessSelector::getConditions() const {
   return conditions;
 }
+const std::list<Condition> &LessSelector::getCompiledConditions() const {
+  return compiledConditions;
+}
+bool LessSelector::usesDefault() const {
+  return _usesDefault;
+}
 
 void LessSelector::addExtension(Extension &extension) {
   extensions.push_back(extension);
@@ -60,7 +68,18 @@ void LessSelector::eraseArguments() {
 }
 
 void LessSelector::addCondition(TokenList &condition) {
+  TokenList::const_iterator it;
+  ValueProcessor processor;
+
   conditions.push_back(condition);
+  compiledConditions.push_back(Condition(condition));
+  processor.compileCondition(compiledConditions.back());
+
+  for (it = condition.begin(); it != condition.end(); it++) {
+    if ((*it).type == Token::IDENTIFIER && *it == "default" &&
+        it + 1 != condition.end() && (*(it + 1)).type == Token::PAREN_OPEN)
+      _usesDefault = true;
+  }
 }
 
 bool LessSelector::matchArguments(const MixinArguments &args) const {
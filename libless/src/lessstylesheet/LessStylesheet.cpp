@@ -1,5 +1,6 @@
 #include "less/lessstylesheet/LessStylesheet.h"
 #include "less/lessstylesheet/LessMediaQuery.h"
+#include "less/lessstylesheet/DependencyGraph.h"
 
 LessStylesheet::LessStylesheet() {
 }
@@ -8,13 +9,10 @@ LessStylesheet::~LessStylesheet() {
 }
 
 LessRuleset* LessStylesheet::createLessRuleset(LessSelector &selector) {
-  std::list<TokenList>::iterator it;
   LessRuleset* r = new LessRuleset(selector, *this);
 
   addRuleset(*r);
-  for(it = selector.begin(); it != selector.end(); it++) {
-    lessrulesets.insert(std::pair<TokenList, LessRuleset*>((*it), r));
-  }
+  lessrulesets.add(*r);
   return r;
 }
 
@@ -39,13 +37,7 @@ LessMediaQuery* LessStylesheet::createLessMediaQuery(const TokenList &selector)
 }
 
 void LessStylesheet::deleteLessRuleset(LessRuleset& ruleset) {
-  std::list<TokenList>::const_iterator it;
-  for(it = ruleset.getLessSelector().begin();
-      it != ruleset.getLessSelector().end();
-      it++) {
-    lessrulesets.erase(*it);
-  }
-
+  lessrulesets.remove(ruleset);
   deleteStatement(ruleset);
 }
 
@@ -53,12 +45,26 @@ void LessStylesheet::deleteMixin(Mixin& mixin) {
   deleteStatement(mixin);
 }
 
+void LessStylesheet::splice(LessStylesheet& stylesheet) {
+  VariableMap::iterator v_it;
+
+  Stylesheet::splice(stylesheet);
+
+  lessrulesets.splice(stylesheet.lessrulesets);
+
+  for (v_it = stylesheet.variables.begin();
+       v_it != stylesheet.variables.end();
+       v_it++) {
+    variables[v_it->first] = v_it->second;
+  }
+  stylesheet.variables.clear();
+}
+
 void LessStylesheet::getFunctions(std::list<const Function*>& functionList,
                                   const Mixin& mixin,
                                   const ProcessingContext &context) const {
-  std::multimap<TokenList,LessRuleset*>::const_iterator i, low, up;
-  const std::list<Closure*>* closures;
-  std::list<Closure*>::const_iterator c_it;
+  const MixinIndex::Bucket* rulesets;
+  MixinIndex::Bucket::const_iterator i;
   TokenList::const_iterator t_it;
   TokenList search;
   for(t_it = mixin.name.begin();
@@ -69,31 +75,34 @@ void LessStylesheet::getFunctions(std::list<const Function*>& functionList,
     search.push_back(*t_it);
   }
 
-  low = lessrulesets.lower_bound(search);
-  up = lessrulesets.upper_bound(search);
-
-  for (i = low; i != up; i++) {
-    (*i).second->getFunctions(functionList, mixin, mixin.name.begin(), context);
-  }
-  
-  closures = context.getBaseClosures();
-  for (c_it = closures->begin(); c_it != closures->end(); c_it++) {
-    (*c_it)->getFunctions(functionList, mixin, mixin.name.begin(), context);
+  // a ruleset is only found through a part of its selector that is the
+  // same as the first element of the name
+  rulesets = lessrulesets.find(mixin.name.begin(), mixin.name.end());
+  if (rulesets != NULL) {
+    for (i = rulesets->begin(); i != rulesets->end(); i++) {
+      if (*(*i).selector == search) {
+        (*i).function->getFunctions(functionList, mixin, mixin.name.begin(),
+                                    context);
+      }
+    }
   }
+
+  context.getBaseClosures()->getFunctions(functionList, mixin,
+                                          mixin.name.begin(), NULL, context);
 }
 
 void LessStylesheet::putVariable(const std::string& key,
                                  const TokenList& value) {
-  variables[key] = value;
+  variables[Symbol(key)] = value;
 }
 const TokenList* LessStylesheet::getVariable(const std::string& key) const {
   return variables.getVariable(key);
 }
-const TokenList* LessStylesheet::getVariable(const std::string& key,
+const TokenList* LessStylesheet::getVariable(const Symbol& key,
                                              const ProcessingContext &context) const {
   const TokenList* t;
 
-  if ((t = getVariable(key)) != NULL)
+  if ((t = variables.getVariable(key)) != NULL)
     return t;
 
   return context.getBaseVariable(key);
@@ -106,11 +115,16 @@ void LessStylesheet::process(Stylesheet& s, void* context) const {
   std::list<Extension>::iterator e_it;
   std::list<Closure*> closureScope;
   Selector* selector;
+  DependencyGraph* graph;
 
   ((ProcessingContext*)context)->setLessStylesheet(*this);
   ((ProcessingContext*)context)->pushExtensionScope(extensions);
 
-  Stylesheet::process(s, context);
+  graph = ((ProcessingContext*)context)->getDependencyGraph();
+  if (graph != NULL && graph->getStylesheet() == this)
+    graph->process(s, *(ProcessingContext*)context);
+  else
+    Stylesheet::process(s, context);
 
   // post processing
   for (e_it = extensions.begin(); e_it != extensions.end(); e_it++) {
@@ -20,8 +20,10 @@ bool Mixin::call(ProcessingContext &context,
 
   std::list<const Function *>::iterator i;
   std::list<const Function *> functionList;
+  // the functions that did not match, but can with 'default()' set
+  std::list<const Function *> defaultList;
   const Function *function;
-  bool success = false;
+  bool success = false, matched;
   
   MixinArguments arguments_p;
   
@@ -42,30 +44,33 @@ bool Mixin::call(ProcessingContext &context,
       context.pushMixinCall(*function, false, isImportant());
 
       if (r_target != NULL)
-        success = function->call(arguments_p, *r_target, context) || success;
+        matched = function->call(arguments_p, *r_target, context);
       else
-        success = function->call(arguments_p, *s_target, context) || success;
+        matched = function->call(arguments_p, *s_target, context);
 
       context.popMixinCall();
+
+      if (matched)
+        success = true;
+      else if (function->getLessSelector().usesDefault())
+        defaultList.push_back(function);
     }
   }
 
-  // if no functions matched, try it with 'default()' set to true.
+  // if no functions matched, try it with 'default()' set to true. A
+  // failed call has no effects, so the functions that do not call
+  // 'default()' would fail again.
   if (!success) {
-    for (i = functionList.begin(); i != functionList.end(); i++) {
+    for (i = defaultList.begin(); i != defaultList.end(); i++) {
       function = *i;
+      context.pushMixinCall(*function, false, isImportant());
 
-      if (function->getLessSelector().needsArguments() ||
-          !context.isInStack(*function)) {
-        context.pushMixinCall(*function, false, isImportant());
-
-        if (r_target != NULL)
-          function->call(arguments_p, *r_target, context, true);
-        else
-          function->call(arguments_p, *s_target, context, true);
+      if (r_target != NULL)
+        function->call(arguments_p, *r_target, context, true);
+      else
+        function->call(arguments_p, *s_target, context, true);
 
-        context.popMixinCall();
-      }
+      context.popMixinCall();
     }
   }
 
@@ -83,6 +88,11 @@ const LessStylesheet *Mixin::getLessStylesheet() const {
   return lessStylesheet;
 }
 
+void Mixin::setStylesheet(Stylesheet *s) {
+  StylesheetStatement::setStylesheet(s);
+  lessStylesheet = (const LessStylesheet *)s;
+}
+
 const LessRuleset *Mixin::getLessRuleset() const {
   return lessRuleset;
 }
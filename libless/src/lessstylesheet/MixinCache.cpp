@@ -0,0 +1,68 @@
+#include "less/lessstylesheet/MixinCache.h"
+#include "less/lessstylesheet/ProcessingContext.h"
+
+MixinCache::MixinCache() : recording(false), cacheable(false) {
+}
+
+const std::list<const Function *> *MixinCache::get(
+    const Mixin &mixin,
+    const Function *caller,
+    const ProcessingContext &context) const {
+  std::unordered_map<const Mixin *, Entry>::const_iterator it;
+  std::vector<ClosureVersion>::const_iterator c;
+
+  if ((it = entries.find(&mixin)) == entries.end() ||
+      it->second.caller != caller)
+    return NULL;
+
+  for (c = it->second.closures.begin(); c != it->second.closures.end(); c++) {
+    if (context.getClosureVersion(c->first) != c->second)
+      return NULL;
+  }
+  return &it->second.functions;
+}
+
+void MixinCache::begin() {
+  recording = true;
+  cacheable = true;
+  closures.clear();
+}
+
+void MixinCache::abort() {
+  recording = false;
+}
+
+void MixinCache::addClosures(const Function *scope, unsigned int version) {
+  std::vector<ClosureVersion>::const_iterator it;
+
+  if (!recording)
+    return;
+
+  // the scopes of the parent rulesets are searched by every lookup
+  // inside them
+  for (it = closures.begin(); it != closures.end(); it++) {
+    if (it->first == scope)
+      return;
+  }
+  closures.push_back(ClosureVersion(scope, version));
+}
+
+void MixinCache::addVariable() {
+  if (recording)
+    cacheable = false;
+}
+
+void MixinCache::put(const Mixin &mixin,
+                     const Function *caller,
+                     const std::list<const Function *> &functions) {
+  Entry *entry;
+
+  recording = false;
+  if (!cacheable)
+    return;
+
+  entry = &entries[&mixin];
+  entry->caller = caller;
+  entry->functions = functions;
+  entry->closures.swap(closures);
+}
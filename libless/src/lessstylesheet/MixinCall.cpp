@@ -10,9 +10,13 @@ MixinCall::MixinCall(MixinCall* parent,
   parent(parent), function(&function), savepoint(savepoint) {
   
   this->important = important || (parent != NULL && parent->important);
+  called = !savepoint || (parent != NULL && parent->called);
+  nested = parent != NULL && function.getParentScope() != NULL &&
+           function.getParentScope() == parent->function &&
+           !parent->isInStack(function);
 }
 
-const TokenList* MixinCall::getVariable(const std::string& key,
+const TokenList* MixinCall::getVariable(const Symbol& key,
                                         const ProcessingContext& context) const {
   const TokenList* t;
     
@@ -0,0 +1,105 @@
+#include "less/lessstylesheet/MixinIndex.h"
+#include "less/lessstylesheet/Function.h"
+#include "less/lessstylesheet/LessSelector.h"
+#include "less/lessstylesheet/Mixin.h"
+
+bool MixinIndex::getKey(TokenList::const_iterator it,
+                        TokenList::const_iterator end,
+                        std::string &key) {
+  if (it != end && *it == ">") {
+    it++;
+    while (it != end && (*it).type == Token::WHITESPACE)
+      it++;
+  }
+  if (it == end)
+    return false;
+
+  key = *it;
+  if (key == ".") {
+    if (++it == end)
+      return false;
+    key.append(*it);
+  }
+  return true;
+}
+
+MixinIndex::MixinIndex() : version(0) {
+}
+
+void MixinIndex::add(const Function &function) {
+  const LessSelector &selector = function.getLessSelector();
+  LessSelector::const_iterator it;
+  std::string key;
+  Entry entry;
+
+  version++;
+  entry.function = &function;
+  for (it = selector.begin(); it != selector.end(); it++) {
+    if (getKey((*it).begin(), (*it).end(), key)) {
+      entry.selector = &(*it);
+      buckets[key].push_back(entry);
+    }
+  }
+}
+
+void MixinIndex::remove(const Function &function) {
+  std::unordered_map<std::string, Bucket>::iterator it;
+  Bucket::iterator e;
+
+  version++;
+  for (it = buckets.begin(); it != buckets.end(); it++) {
+    for (e = it->second.begin(); e != it->second.end();) {
+      if (e->function == &function)
+        e = it->second.erase(e);
+      else
+        e++;
+    }
+  }
+}
+
+void MixinIndex::splice(MixinIndex &index) {
+  std::unordered_map<std::string, Bucket>::iterator it;
+  Bucket *bucket;
+
+  version++;
+  index.version++;
+  for (it = index.buckets.begin(); it != index.buckets.end(); it++) {
+    bucket = &buckets[it->first];
+    bucket->insert(bucket->end(), it->second.begin(), it->second.end());
+  }
+  index.buckets.clear();
+}
+
+unsigned int MixinIndex::getVersion() const {
+  return version;
+}
+
+const MixinIndex::Bucket *MixinIndex::find(
+    TokenList::const_iterator offset, TokenList::const_iterator end) const {
+  std::unordered_map<std::string, Bucket>::const_iterator it;
+  std::string key;
+
+  if (!getKey(offset, end, key) || (it = buckets.find(key)) == buckets.end())
+    return NULL;
+  return &it->second;
+}
+
+void MixinIndex::getFunctions(std::list<const Function *> &functionList,
+                              const Mixin &mixin,
+                              TokenList::const_iterator offset,
+                              const Function *exclude,
+                              const ProcessingContext &context) const {
+  const Bucket *bucket = find(offset, mixin.name.end());
+  Bucket::const_iterator it;
+  const Function *last = NULL;
+
+  if (bucket == NULL)
+    return;
+
+  for (it = bucket->begin(); it != bucket->end(); it++) {
+    // the parts of a selector are added one after the other
+    if (it->function != last && it->function != exclude)
+      it->function->getFunctions(functionList, mixin, offset, context);
+    last = it->function;
+  }
+}
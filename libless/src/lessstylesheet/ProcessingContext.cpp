@@ -1,4 +1,5 @@
 #include "less/lessstylesheet/ProcessingContext.h"
+#include "less/lessstylesheet/DependencyGraph.h"
 #include "less/lessstylesheet/LessRuleset.h"
 #include "less/lessstylesheet/LessStylesheet.h"
 #include "less/lessstylesheet/MixinCall.h"
@@ -6,6 +7,9 @@
 ProcessingContext::ProcessingContext() {
   stack = NULL;
   contextStylesheet = NULL;
+  dependencyGraph = NULL;
+  dependencies = NULL;
+  generation = 1;
 }
 
 void ProcessingContext::setLessStylesheet(const LessStylesheet &stylesheet) {
@@ -15,19 +19,83 @@ const LessStylesheet *ProcessingContext::getLessStylesheet() const {
   return contextStylesheet;
 }
 
+void ProcessingContext::setDependencyGraph(DependencyGraph *graph) {
+  dependencyGraph = graph;
+}
+DependencyGraph *ProcessingContext::getDependencyGraph() const {
+  return dependencyGraph;
+}
+
+void ProcessingContext::setDependencies(Dependencies *dependencies) {
+  this->dependencies = dependencies;
+}
+
 const TokenList *ProcessingContext::getVariable(const std::string &key) const {
+  // a name that was never interned is not the name of any variable
+  Symbol symbol = Symbol::find(key);
+
+  if (!symbol.isNull())
+    return getVariable(symbol);
+
+  if (dependencies != NULL)
+    dependencies->variables.insert(key);
+  values.addLookup(symbol, NULL);
+  mixins.addVariable();
+  return NULL;
+}
+
+const TokenList *ProcessingContext::getVariable(const Symbol &key) const {
   const TokenList* t;
-  
-  if (stack != NULL) {
-    if ((t = stack->getVariable(key, *this)) != NULL)
-      return t;
-    return NULL;
+
+  if (dependencies != NULL)
+    dependencies->variables.insert(key.getString());
+
+  if (stack != NULL)
+    t = resolveVariable(key, *stack, false);
+  else
+    t = getLessStylesheet()->getVariable(key, *this);
+
+  values.addLookup(key, t);
+  mixins.addVariable();
+  return t;
+}
+
+ValueCache *ProcessingContext::getValueCache() const {
+  values.setGeneration(generation);
+  return &values;
+}
+
+const TokenList *ProcessingContext::resolveVariable(const Symbol &key,
+                                                   const MixinCall &call,
+                                                   bool nested) const {
+  const TokenList* t;
+
+  // the arguments of a call are set before anything is looked up in it,
+  // so the result only changes through addVariables().
+  call.resolved.setGeneration(generation);
+  if (call.resolved.get(key, t))
+    return t;
+
+  // A ruleset that is processed inside its parent sees the variables of
+  // the parent after its own, so the lookup continues with the result
+  // of the call below it. That does not hold if the ruleset has
+  // arguments, which the calls below would see as well.
+  if (call.nested && call.arguments.empty()) {
+    if ((t = call.function->getLocalVariable(key)) == NULL &&
+        (t = getFunctionVariable(key, call.function)) == NULL)
+      t = resolveVariable(key, *call.parent, true);
   } else
-    return getLessStylesheet()->getVariable(key, *this);
+    t = call.getVariable(key, *this);
+
+  // only the results that the rulesets inside the call can use again
+  // are worth storing
+  if (nested)
+    call.resolved.put(key, t);
+  return t;
 }
 
 const TokenList *ProcessingContext::getFunctionVariable
-(const std::string &key,
+(const Symbol &key,
  const Function* function) const {
   
   std::map<const Function*, VariableMap>::const_iterator it;
@@ -39,7 +107,7 @@ const TokenList *ProcessingContext::getFunctionVariable
 }
 
 const TokenList *ProcessingContext::getBaseVariable
-(const std::string &key) const {
+(const Symbol &key) const {
   return base_variables.getVariable(key);
 }
 
@@ -92,10 +160,42 @@ bool ProcessingContext::isImportant() const {
 
 void ProcessingContext::getFunctions(std::list<const Function *> &functionList,
                                      const Mixin &mixin) const {
-  if (stack != NULL)
-    stack->getFunctions(functionList, mixin, *this);
-  else if (contextStylesheet != NULL)
-    contextStylesheet->getFunctions(functionList, mixin, *this);
+  const std::list<const Function *> *cached;
+
+  if (dependencies != NULL)
+    dependencies->addNames(mixin.name);
+
+  // a mixin outside of mixin calls is only looked up once
+  if (stack == NULL || !stack->called) {
+    if (stack != NULL)
+      stack->getFunctions(functionList, mixin, *this);
+    else if (contextStylesheet != NULL)
+      contextStylesheet->getFunctions(functionList, mixin, *this);
+    return;
+  }
+
+  if ((cached = mixins.get(mixin, stack->function, *this)) != NULL) {
+    functionList.insert(functionList.end(), cached->begin(), cached->end());
+    return;
+  }
+
+  mixins.begin();
+  try {
+    stack->function->getLocalFunctions(functionList, mixin, *this);
+  } catch (...) {
+    mixins.abort();
+    throw;
+  }
+
+  // what the calls further down the stack find depends on more than
+  // the caller
+  if (!functionList.empty()) {
+    mixins.put(mixin, stack->function, functionList);
+    return;
+  }
+  mixins.abort();
+  if (stack->parent != NULL)
+    stack->parent->getFunctions(functionList, mixin, *this);
 }
 
 bool ProcessingContext::isInStack(const Function &function) const {
@@ -129,31 +229,56 @@ void ProcessingContext::addClosure(const LessRuleset &ruleset) {
   Closure *c = new Closure(ruleset, *stack);
   
   if (fnc != NULL)
-    closures[fnc].push_back(c);
-  else
-    base_closures.push_back(c);
+    closures[fnc].add(*c);
+  else {
+    base_closures.add(*c);
+    if (dependencies != NULL)
+      dependencies->sideEffects = true;
+  }
 }
 
 void ProcessingContext::addVariables(const VariableMap &variables) {
   const Function* fnc = getSavePoint();
+
+  // an empty map can not hide what was looked up before
+  if (!variables.empty())
+    generation++;
   if (fnc != NULL)
     this->variables[fnc].overwrite(variables);
-  else
+  else {
     base_variables.overwrite(variables);
+    if (dependencies != NULL)
+      dependencies->sideEffects = true;
+  }
 }
 
-const std::list<Closure *> *ProcessingContext::getClosures(const Function *function) const {
-  std::map<const Function*, std::list<Closure *>>::const_iterator it;
+const MixinIndex *ProcessingContext::getClosures(const Function *function) const {
+  std::map<const Function*, MixinIndex>::const_iterator it;
 
-  if ((it = closures.find(function)) != closures.end())
+  if ((it = closures.find(function)) != closures.end()) {
+    mixins.addClosures(function, (*it).second.getVersion());
     return &(*it).second;
-  else
+  } else {
+    mixins.addClosures(function, 0);
     return NULL;
+  }
 }
-const std::list<Closure *> *ProcessingContext::getBaseClosures() const {
+const MixinIndex *ProcessingContext::getBaseClosures() const {
+  mixins.addClosures(NULL, base_closures.getVersion());
   return &base_closures;
 }
 
+unsigned int ProcessingContext::getClosureVersion(
+    const Function *function) const {
+  std::map<const Function*, MixinIndex>::const_iterator it;
+
+  if (function == NULL)
+    return base_closures.getVersion();
+  if ((it = closures.find(function)) != closures.end())
+    return (*it).second.getVersion();
+  return 0;
+}
+
 ValueProcessor *ProcessingContext::getValueProcessor() {
   return &processor;
 }
@@ -176,7 +301,15 @@ void ProcessingContext::interpolate(std::string &str) const {
 void ProcessingContext::processValue(TokenList &value) const {
   processor.processValue(value, *this);
 }
+void ProcessingContext::processValue(const CompiledValue &value,
+                                     TokenList &result) const {
+  processor.processValue(value, result, *this);
+}
 
 bool ProcessingContext::validateCondition(const TokenList &value, bool defaultVal) const {
   return processor.validateCondition(value, *this, defaultVal);
 }
+bool ProcessingContext::validateCondition(const Condition &condition,
+                                          bool defaultVal) const {
+  return processor.validateCondition(condition, *this, defaultVal);
+}
@@ -0,0 +1,55 @@
+#include "less/lessstylesheet/VariableCache.h"
+
+static const size_t INITIAL_SLOTS = 8;
+
+VariableCache::VariableCache() : size(0), generation(0) {
+}
+
+void VariableCache::setGeneration(unsigned int generation) {
+  if (this->generation == generation)
+    return;
+  this->generation = generation;
+  if (size > 0) {
+    slots.assign(slots.size(), Slot());
+    size = 0;
+  }
+}
+
+size_t VariableCache::findSlot(unsigned int id) const {
+  size_t mask = slots.size() - 1;
+  size_t i = (id * 2654435761u) & mask;
+
+  while (slots[i].id != 0 && slots[i].id != id)
+    i = (i + 1) & mask;
+  return i;
+}
+
+bool VariableCache::get(const Symbol &key, const TokenList *&value) const {
+  size_t i;
+
+  if (size == 0 || slots[i = findSlot(key.getId())].id == 0)
+    return false;
+  value = slots[i].value;
+  return true;
+}
+
+void VariableCache::put(const Symbol &key, const TokenList *value) {
+  std::vector<Slot> old;
+  size_t i;
+
+  // keep the table at most half full
+  if ((size + 1) * 2 > slots.size()) {
+    old.swap(slots);
+    slots.assign(old.empty() ? INITIAL_SLOTS : old.size() * 2, Slot());
+    for (i = 0; i < old.size(); i++) {
+      if (old[i].id != 0)
+        slots[findSlot(old[i].id)] = old[i];
+    }
+  }
+
+  i = findSlot(key.getId());
+  if (slots[i].id == 0)
+    size++;
+  slots[i].id = key.getId();
+  slots[i].value = value;
+}
@@ -16,12 +16,14 @@ const TokenList& MediaQuery::getSelector() const {
 }
 
 MediaQuery* MediaQuery::createMediaQuery(const TokenList &selector) {
-  TokenList s = selector;
-  s.pop_front();
-
-  s.push_front(BUILTIN_AND);
-  s.push_front(Token::BUILTIN_SPACE);
-  s.insert(s.begin(), getSelector().begin(), getSelector().end());
+  TokenList s;
+
+  s.reserve(getSelector().size() + selector.size() + 1);
+  s.insert(s.end(), getSelector().begin(), getSelector().end());
+  s.push_back(Token::BUILTIN_SPACE);
+  s.push_back(BUILTIN_AND);
+  if (!selector.empty())
+    s.insert(s.end(), selector.begin() + 1, selector.end());
   
   return getStylesheet()->createMediaQuery(s);
 }
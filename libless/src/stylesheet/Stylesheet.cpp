@@ -59,6 +59,17 @@ void Stylesheet::deleteStatement(StylesheetStatement& statement) {
   delete &statement;
 }
 
+void Stylesheet::splice(Stylesheet& s) {
+  std::list<StylesheetStatement*>::iterator it;
+
+  for (it = s.statements.begin(); it != s.statements.end(); it++)
+    (*it)->setStylesheet(this);
+
+  statements.splice(statements.end(), s.statements);
+  rulesets.splice(rulesets.end(), s.rulesets);
+  atrules.splice(atrules.end(), s.atrules);
+}
+
 void Stylesheet::deleteRuleset(Ruleset& ruleset) {
   rulesets.remove(&ruleset);
   deleteStatement(ruleset);
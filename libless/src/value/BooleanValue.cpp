@@ -15,6 +15,10 @@ BooleanValue::BooleanValue(const Token &t, bool value) {
 BooleanValue::~BooleanValue() {
 }
 
+Value *BooleanValue::clone() const {
+  return new BooleanValue(*this);
+}
+
 bool BooleanValue::getValue() const {
   return value;
 }
@@ -35,20 +39,19 @@ Value *BooleanValue::add(const Value &v) const {
     return ret;
   }
 
-  throw new ValueException("Can't add boolean types.", *this->getTokens());
+  return NULL;
 }
 Value *BooleanValue::substract(const Value &v) const {
   (void)v;
-  throw new ValueException("Can't substract boolean types.",
-                           *this->getTokens());
+  return NULL;
 }
 Value *BooleanValue::multiply(const Value &v) const {
   (void)v;
-  throw new ValueException("Can't multiply boolean types.", *this->getTokens());
+  return NULL;
 }
 Value *BooleanValue::divide(const Value &v) const {
   (void)v;
-  throw new ValueException("Can't divide boolean types.", *this->getTokens());
+  return NULL;
 }
 BooleanValue *BooleanValue::equals(const Value &v) const {
   const BooleanValue *b;
@@ -28,12 +28,20 @@ double Color::minArray(double* array, const size_t len) const {
   return ret;
 }
 
-void Color::updateTokens() {
+void Color::clearTokens() {
+  tokens.clear();
+  tokens.push_back(Token(0, 0, "generated"));
+  formatted = false;
+}
+
+void Color::updateTokens() const {
+  Token location(0, 0, "generated");
   ostringstream stm;
   string sColor[3];
   string hash;
   int i;
 
+  location.setLocation(tokens.front());
   tokens.clear();
 
   // If the color is not opaque the rgba() function needs to be used.
@@ -80,9 +88,18 @@ void Color::updateTokens() {
 
     tokens.push_back(Token(hash, Token::HASH, 0, 0, "generated"));
   }
+  tokens.front().setLocation(location);
+}
+
+const TokenList* Color::getTokens() const {
+  if (!formatted) {
+    updateTokens();
+    formatted = true;
+  }
+  return &tokens;
 }
 
-Color::Color(const Token &hash) : Value() {
+Color::Color(const Token &hash) : Value(), formatted(true) {
   tokens.push_back(hash);
   type = Value::COLOR;
   
@@ -93,7 +110,8 @@ Color::Color(const Token &hash) : Value() {
   }
 }
 
-Color::Color(const Token &name, const char* hash) : Value() {
+Color::Color(const Token &name, const char* hash)
+    : Value(), formatted(true) {
   tokens.push_back(name);
   type = Value::COLOR;
   
@@ -110,7 +128,7 @@ Color::Color() : Value() {
   color[RGB_GREEN] = 0;
   color[RGB_BLUE] = 0;
   alpha = 1.0;
-  updateTokens();
+  clearTokens();
 }
 
 Color::Color(unsigned int red, unsigned int green, unsigned int blue)
@@ -120,7 +138,7 @@ Color::Color(unsigned int red, unsigned int green, unsigned int blue)
   color[RGB_GREEN] = green;
   color[RGB_BLUE] = blue;
   alpha = 1;
-  updateTokens();
+  clearTokens();
 }
 
 Color::Color(unsigned int red,
@@ -133,7 +151,7 @@ Color::Color(unsigned int red,
   color[RGB_GREEN] = green;
   color[RGB_BLUE] = blue;
   this->alpha = alpha;
-  updateTokens();
+  clearTokens();
 }
 
 bool Color::parseHash(const char* hash) {
@@ -180,7 +198,7 @@ bool Color::parseHash(const char* hash) {
 }
 
 Color* Color::fromName(const Token &name) {
-  std::map<std::string, const char*>::iterator it;
+  std::map<std::string, const char*>::const_iterator it;
   it = ColorNames.find(name);
   
   if (it != ColorNames.end())
@@ -246,12 +264,20 @@ Color::Color(const Color& color) {
   this->color[RGB_GREEN] = color.getGreen();
   this->color[RGB_BLUE] = color.getBlue();
   alpha = color.getAlpha();
-  updateTokens();
+  clearTokens();
 }
 
 Color::~Color() {
 }
 
+Value* Color::clone() const {
+  Color* ret = new Color(*this);
+
+  ret->tokens = tokens;
+  ret->formatted = formatted;
+  return ret;
+}
+
 Value* Color::add(const Value& v) const {
   const Color* c;
   const NumberValue* n;
@@ -279,10 +305,7 @@ Value* Color::add(const Value& v) const {
       return ret;
 
     default:
-      throw new ValueException(
-          "You can only add colors with other \
-colors, numbers or strings.",
-          *this->getTokens());
+      return NULL;
   }
 }
 Value* Color::substract(const Value& v) const {
@@ -308,10 +331,7 @@ Value* Color::substract(const Value& v) const {
                        max(color[RGB_GREEN] - n->getValue(), 0),
                        max(color[RGB_BLUE] - n->getValue(), 0));
     default:
-      throw new ValueException(
-          "You can only substract a color or \
-a number from a color.",
-          *this->getTokens());
+      return NULL;
   }
 }
 
@@ -335,10 +355,7 @@ Value* Color::multiply(const Value& v) const {
                        min(color[RGB_BLUE] * n->getValue(), 255));
 
     default:
-      throw new ValueException(
-          "You can only multiply a color by a \
-color or a number.",
-          *this->getTokens());
+      return NULL;
   }
 }
 Value* Color::divide(const Value& v) const {
@@ -359,10 +376,7 @@ Value* Color::divide(const Value& v) const {
                        color[RGB_GREEN] / n->getValue(),
                        color[RGB_BLUE] / n->getValue());
     default:
-      throw new ValueException(
-          "You can only divide a color by a \
-color or a number.",
-          *this->getTokens());
+      return NULL;
   }
 }
 
@@ -383,8 +397,7 @@ BooleanValue* Color::equals(const Value& v) const {
     return new BooleanValue(false == b->getValue());
     
   default:
-      throw new ValueException("You can only compare a color with a *color*.",
-                               *this->getTokens());
+      return NULL;
   }
 }
 
@@ -403,8 +416,7 @@ BooleanValue* Color::lessThan(const Value& v) const {
     return new BooleanValue(b->getValue());
 
   default:
-      throw new ValueException("You can only compare a color with a *color*.",
-                               *this->getTokens());
+      return NULL;
   }
 }
 
@@ -412,11 +424,11 @@ void Color::setRGB(unsigned int red, unsigned int green, unsigned int blue) {
   color[RGB_RED] = red;
   color[RGB_GREEN] = green;
   color[RGB_BLUE] = blue;
-  updateTokens();
+  clearTokens();
 }
 void Color::setAlpha(double alpha) {
   this->alpha = min(max(alpha, 0.0), 1.0);
-  updateTokens();
+  clearTokens();
 }
 double Color::getAlpha() const {
   return alpha;
@@ -674,7 +686,7 @@ Value* Color::_alpha(const vector<const Value*>& arguments) {
   return new NumberValue(c->getAlpha());
 }
 
-std::map<string,const char*> Color::ColorNames = {
+const std::map<string,const char*> Color::ColorNames = {
   {"black",		"#000000"},
   {"silver",		"#c0c0c0"},
   {"gray",		"#808080"},
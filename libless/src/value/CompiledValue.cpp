@@ -0,0 +1,23 @@
+#include "less/value/CompiledValue.h"
+
+CompiledValue::CompiledValue(const TokenList &tokens) : Expression(tokens) {
+}
+
+const std::vector<CompiledValue::Segment> &CompiledValue::getSegments()
+    const {
+  return segments;
+}
+
+void CompiledValue::addSegment(Kind kind, size_t index, size_t end) {
+  Segment segment;
+
+  segment.kind = kind;
+  segment.index = index;
+  segment.end = end;
+  segments.push_back(segment);
+}
+
+void CompiledValue::clear() {
+  Expression::clear();
+  segments.clear();
+}
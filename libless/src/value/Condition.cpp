@@ -0,0 +1,17 @@
+#include "less/value/Condition.h"
+
+Condition::Condition(const TokenList &tokens)
+    : Expression(tokens), negated(false) {
+}
+
+bool Condition::isNegated() const {
+  return negated;
+}
+void Condition::setNegated(bool negated) {
+  this->negated = negated;
+}
+
+void Condition::clear() {
+  Expression::clear();
+  negated = false;
+}
@@ -0,0 +1,93 @@
+#include "less/value/Expression.h"
+#include "less/value/Value.h"
+
+Expression::Expression(const TokenList &tokens)
+    : tokens(tokens), compiled(false) {
+}
+
+Expression::Expression(const Expression &expression) : compiled(false) {
+  *this = expression;
+}
+
+Expression::~Expression() {
+  Expression::clear();
+}
+
+Expression &Expression::operator=(const Expression &expression) {
+  std::vector<Value *>::const_iterator it;
+
+  if (this == &expression)
+    return *this;
+
+  Expression::clear();
+  tokens = expression.tokens;
+  compiled = expression.compiled;
+  statements = expression.statements;
+  symbols = expression.symbols;
+  for (it = expression.constants.begin(); it != expression.constants.end();
+       it++) {
+    constants.push_back((*it)->clone());
+  }
+  return *this;
+}
+
+const TokenList &Expression::getTokens() const {
+  return tokens;
+}
+
+bool Expression::isCompiled() const {
+  return compiled;
+}
+void Expression::setCompiled(bool compiled) {
+  this->compiled = compiled;
+}
+
+const std::vector<Expression::Statement> &Expression::getStatements() const {
+  return statements;
+}
+
+const Value &Expression::getConstant(size_t index) const {
+  return *constants[index];
+}
+
+const Symbol &Expression::getSymbol(size_t index) const {
+  return symbols[index];
+}
+
+void Expression::addStatement() {
+  statements.push_back(Statement());
+}
+
+void Expression::addInstruction(Code code, size_t index, size_t end) {
+  Instruction instruction;
+
+  instruction.code = code;
+  instruction.index = index;
+  instruction.end = end;
+  statements.back().push_back(instruction);
+}
+
+void Expression::addConstant(Value *value) {
+  addInstruction(CONSTANT, storeConstant(value));
+}
+
+size_t Expression::storeConstant(Value *value) {
+  constants.push_back(value);
+  return constants.size() - 1;
+}
+
+size_t Expression::storeSymbol(const Symbol &symbol) {
+  symbols.push_back(symbol);
+  return symbols.size() - 1;
+}
+
+void Expression::clear() {
+  std::vector<Value *>::iterator it;
+
+  for (it = constants.begin(); it != constants.end(); it++)
+    delete *it;
+  constants.clear();
+  statements.clear();
+  symbols.clear();
+  compiled = false;
+}
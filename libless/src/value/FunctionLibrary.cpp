@@ -1,9 +1,14 @@
 #include "less/value/FunctionLibrary.h"
 
 const FuncInfo* FunctionLibrary::getFunction(const char* functionName) const {
-  std::map<std::string, FuncInfo*>::const_iterator i = map.find(functionName);
+  return getFunction(Symbol::find(functionName));
+}
+
+const FuncInfo* FunctionLibrary::getFunction(
+    const Symbol& functionName) const {
+  std::map<Symbol, FuncInfo*>::const_iterator i;
 
-  if (i != map.end())
+  if (!functionName.isNull() && (i = map.find(functionName)) != map.end())
     return i->second;
   else
     return NULL;
@@ -16,7 +21,7 @@ void FunctionLibrary::push(
   FuncInfo* fi = new FuncInfo();
   fi->parameterTypes = parameterTypes;
   fi->func = func;
-  map[name] = fi;
+  map[Symbol(name)] = fi;
 }
 
 bool FunctionLibrary::checkArguments(
@@ -1,7 +1,11 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
 #include "less/value/NumberValue.h"
 #include "less/value/FunctionLibrary.h"
 
-NumberValue::NumberValue(const Token& token) {
+NumberValue::NumberValue(const Token& token) : value(0), formatted(true) {
   tokens.push_back(token);
 
   switch (token.type) {
@@ -20,15 +24,17 @@ NumberValue::NumberValue(const Token& token) {
           "number, percentage or dimension",
           *this->getTokens());
   }
+  parse(token);
 }
-NumberValue::NumberValue(double value) {
+NumberValue::NumberValue(double value) : formatted(true) {
   tokens.push_back(Token("", Token::NUMBER, 0, 0, "generated"));
   type = NUMBER;
   setValue(value);
 }
 NumberValue::NumberValue(double value,
                          Token::Type type,
-                         const std::string* unit) {
+                         const std::string* unit)
+    : formatted(true) {
   if (type != Token::NUMBER && type != Token::PERCENTAGE &&
       type != Token::DIMENSION) {
     throw new ValueException(
@@ -50,28 +56,56 @@ NumberValue::NumberValue(double value,
       break;
     case Token::DIMENSION:
       this->type = DIMENSION;
+      suffix = *unit;
       break;
     default:
       break;
   }
-
-  ostringstream stm;
-  stm << setprecision(10) << value;
-  if (type == Token::DIMENSION)
-    stm << *unit;
-  else if (type == Token::PERCENTAGE)
-    stm << "%";
-  tokens.front() = stm.str();
+  setValue(value);
 }
 
-NumberValue::NumberValue(const NumberValue& n) {
-  tokens.push_back(n.getTokens()->front());
-  this->type = n.type;
+NumberValue::NumberValue(const NumberValue& n)
+    : Value(n), value(n.value), suffix(n.suffix), formatted(n.formatted) {
 }
 
 NumberValue::~NumberValue() {
 }
 
+void NumberValue::parse(const std::string& number) {
+  istringstream stm;
+  size_t i;
+
+  for (i = 0; i < number.size(); i++) {
+    if (!isdigit(number[i]) && number[i] != '.' && number[i] != '-')
+      break;
+  }
+  suffix = number.substr(i);
+
+  if (i > 0) {
+    value = strtod(number.substr(0, i).c_str(), NULL);
+  } else {
+    // not a plain number, like "inf"; read as far as a stream reads it
+    stm.str(number);
+    stm >> value;
+  }
+}
+
+const TokenList* NumberValue::getTokens() const {
+  char buffer[32];
+
+  if (!formatted) {
+    snprintf(buffer, sizeof(buffer), "%.10g", value);
+    tokens.front() = buffer;
+    tokens.front().append(suffix);
+    formatted = true;
+  }
+  return &tokens;
+}
+
+Value *NumberValue::clone() const {
+  return new NumberValue(*this);
+}
+
 void NumberValue::verifyUnits(const NumberValue& n) {
   if (type == Value::DIMENSION && n.type == Value::DIMENSION &&
       getUnit().compare(n.getUnit()) != 0) {
@@ -137,7 +171,7 @@ Value* NumberValue::add(const Value& v) const {
     return sret;
 
   } else {
-    throw new ValueException("Unsupported type.", *this->getTokens());
+    return NULL;
   }
 }
 Value* NumberValue::substract(const Value& v) const {
@@ -159,10 +193,7 @@ Value* NumberValue::substract(const Value& v) const {
 
     return ret;
   } else
-    throw new ValueException(
-        "You can only substract a "
-        "*number* from a number.",
-        *this->getTokens());
+    return NULL;
 }
 Value* NumberValue::multiply(const Value& v) const {
   const NumberValue* n;
@@ -188,7 +219,7 @@ Value* NumberValue::multiply(const Value& v) const {
     return static_cast<const StringValue*>(&v)->multiply(*this);
 
   } else {
-    throw new ValueException("Unsupported type.", *this->getTokens());
+    return NULL;
   }
 }
 
@@ -210,10 +241,7 @@ Value* NumberValue::divide(const Value& v) const {
 
     return ret;
   } else
-    throw new ValueException(
-        "You can only divide a number "
-        "by a *number*.",
-        *this->getTokens());
+    return NULL;
 }
 
 BooleanValue* NumberValue::equals(const Value& v) const {
@@ -228,10 +256,7 @@ BooleanValue* NumberValue::equals(const Value& v) const {
     b = static_cast<const BooleanValue*>(&v);
     return new BooleanValue(false == b->getValue());
   } else {
-    throw new ValueException(
-        "You can only compare a number "
-        "with a *number*.",
-        *this->getTokens());
+    return NULL;
   }
 }
 
@@ -246,10 +271,7 @@ BooleanValue* NumberValue::lessThan(const Value& v) const {
     b = static_cast<const BooleanValue*>(&v);
     return new BooleanValue(b->getValue());
   } else {
-    throw new ValueException(
-        "You can only compare a number "
-        "with a *number*.",
-        *this->getTokens());
+    return NULL;
   }
 }
 
@@ -265,41 +287,14 @@ void NumberValue::setType(const NumberValue& n) {
 }
 
 double NumberValue::getValue() const {
-  string number;
-  istringstream stm;
-  double ret;
-  char c;
-
-  for (unsigned int i = 0; i < tokens.front().size(); i++) {
-    c = tokens.front()[i];
-    if (!isdigit(c) && c != '.' && c != '-') {
-      number = tokens.front().substr(0, i);
-      break;
-    }
-  }
-  if (number == "")
-    number = tokens.front();
-  stm.str(number);
-  stm >> ret;
-  return ret;
+  return value;
 }
 string NumberValue::getUnit() const {
-  char c;
-  unsigned int i;
-
-  for (i = 0; i < tokens.front().size(); i++) {
-    c = tokens.front()[i];
-    if (!isdigit(c) && c != '.' && c != '-')
-      return tokens.front().substr(i);
-  }
-  return string("");
+  return suffix;
 }
 
 void NumberValue::setUnit(string unit) {
-  ostringstream stm;
-  stm << setprecision(10) << getValue();
-  stm << unit;
-  tokens.front() = stm.str();
+  suffix = unit;
 
   if (unit.length() == 0) {
     type = NUMBER;
@@ -308,16 +303,35 @@ void NumberValue::setUnit(string unit) {
     type = DIMENSION;
     tokens.front().type = Token::DIMENSION;
   }
+  setValue(value);
 }
 
 void NumberValue::setValue(double d) {
-  ostringstream stm;
-  stm << setprecision(10) << d;
-  if (type == DIMENSION)
-    stm << getUnit();
-  else if (type == PERCENTAGE)
-    stm << "%";
-  tokens.front() = stm.str();
+  char buffer[32];
+
+  if (type == PERCENTAGE)
+    suffix = "%";
+  else if (type != DIMENSION)
+    suffix.clear();
+
+  formatted = false;
+  if (d == std::floor(d) && std::fabs(d) < 1e10) {
+    value = d;
+    return;
+  }
+
+  // the value is rounded to the digits it is written with
+  snprintf(buffer, sizeof(buffer), "%.10g", d);
+  if (strspn(buffer, "0123456789.-") == strlen(buffer)) {
+    value = strtod(buffer, NULL);
+  } else {
+    // an exponent or a value that is not finite is read back from the
+    // token, the same as a number in the stylesheet
+    tokens.front() = buffer;
+    tokens.front().append(suffix);
+    parse(tokens.front());
+    formatted = true;
+  }
 }
 
 bool NumberValue::isNumber(const Value& val) {
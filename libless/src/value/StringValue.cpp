@@ -49,6 +49,13 @@ StringValue::StringValue(const Value& val, bool quotes) {
 StringValue::~StringValue() {
 }
 
+Value *StringValue::clone() const {
+  StringValue *ret = new StringValue(*this);
+
+  ret->tokens = tokens;
+  return ret;
+}
+
 void StringValue::updateTokens() {
   std::string::iterator i;
   std::string newstr;
@@ -105,7 +112,7 @@ Value* StringValue::add(const Value& v) const {
 
 Value* StringValue::substract(const Value& v) const {
   (void)v;
-  throw new ValueException("Can't substract from strings.", *this->getTokens());
+  return NULL;
 }
 Value* StringValue::multiply(const Value& v) const {
   std::string newstr;
@@ -113,8 +120,7 @@ Value* StringValue::multiply(const Value& v) const {
   const NumberValue* n;
 
   if (v.type != Value::NUMBER) {
-    throw new ValueException("Strings can only be multiplied by a number.",
-                             *this->getTokens());
+    return NULL;
   }
 
   n = static_cast<const NumberValue*>(&v);
@@ -127,7 +133,7 @@ Value* StringValue::multiply(const Value& v) const {
 
 Value* StringValue::divide(const Value& v) const {
   (void)v;
-  throw new ValueException("Can't divide strings.", *this->getTokens());
+  return NULL;
 }
 
 BooleanValue* StringValue::equals(const Value& v) const {
@@ -143,8 +149,7 @@ BooleanValue* StringValue::equals(const Value& v) const {
     b = static_cast<const BooleanValue*>(&v);
     return new BooleanValue(false == b->getValue());
   } else {
-    throw new ValueException("You can only compare a string with a *string*.",
-                             *this->getTokens());
+    return NULL;
   }
 }
 BooleanValue* StringValue::lessThan(const Value& v) const {
@@ -158,8 +163,7 @@ BooleanValue* StringValue::lessThan(const Value& v) const {
     b = static_cast<const BooleanValue*>(&v);
     return new BooleanValue(b->getValue());
   } else {
-    throw new ValueException("You can only compare a string with a *string*.",
-                             *this->getTokens());
+    return NULL;
   }
 }
 
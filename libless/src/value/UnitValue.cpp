@@ -8,6 +8,10 @@ UnitValue::UnitValue(Token &token) {
 UnitValue::~UnitValue() {
 }
 
+Value *UnitValue::clone() const {
+  return new UnitValue(*this);
+}
+
 const char *UnitValue::getUnit() const {
   return tokens.front().c_str();
 }
@@ -25,19 +29,19 @@ Value *UnitValue::add(const Value &v) const {
     ret->add(v);
     return ret;
   }
-  throw new ValueException("Can't do math on unit types.", *this->getTokens());
+  return NULL;
 }
 Value *UnitValue::substract(const Value &v) const {
   (void)v;
-  throw new ValueException("Can't do math on unit types.", *this->getTokens());
+  return NULL;
 }
 Value *UnitValue::multiply(const Value &v) const {
   (void)v;
-  throw new ValueException("Can't do math on unit types.", *this->getTokens());
+  return NULL;
 }
 Value *UnitValue::divide(const Value &v) const {
   (void)v;
-  throw new ValueException("Can't do math on unit types.", *this->getTokens());
+  return NULL;
 }
 
 BooleanValue *UnitValue::lessThan(const Value &v) const {
@@ -53,8 +57,7 @@ BooleanValue *UnitValue::lessThan(const Value &v) const {
     return new BooleanValue(b->getValue());
 
   } else {
-    throw new ValueException("You can only compare a unit with a *unit*.",
-                             *this->getTokens());
+    return NULL;
   }
 }
 BooleanValue *UnitValue::equals(const Value &v) const {
@@ -71,8 +74,7 @@ BooleanValue *UnitValue::equals(const Value &v) const {
     return new BooleanValue(false == b->getValue());
 
   } else {
-    throw new ValueException("You can only compare a unit with a *unit*.",
-                             *this->getTokens());
+    return NULL;
   }
 }
 
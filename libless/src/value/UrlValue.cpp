@@ -45,6 +45,10 @@ UrlValue::UrlValue(Token& token, std::string& path) : Value() {
 UrlValue::~UrlValue() {
 }
 
+Value *UrlValue::clone() const {
+  return new UrlValue(*this);
+}
+
 std::string UrlValue::getPath() const {
   return path;
 }
@@ -66,19 +70,19 @@ std::string UrlValue::getRelativePath() const {
 
 Value* UrlValue::add(const Value& v) const {
   (void)v;
-  throw new ValueException("You can not add urls.", *this->getTokens());
+  return NULL;
 }
 Value* UrlValue::substract(const Value& v) const {
   (void)v;
-  throw new ValueException("You can not substract urls.", *this->getTokens());
+  return NULL;
 }
 Value* UrlValue::multiply(const Value& v) const {
   (void)v;
-  throw new ValueException("You can not multiply urls.", *this->getTokens());
+  return NULL;
 }
 Value* UrlValue::divide(const Value& v) const {
   (void)v;
-  throw new ValueException("You can not divide urls.", *this->getTokens());
+  return NULL;
 }
 
 BooleanValue* UrlValue::lessThan(const Value& v) const {
@@ -94,8 +98,7 @@ BooleanValue* UrlValue::lessThan(const Value& v) const {
     return new BooleanValue(b->getValue());
 
   } else {
-    throw new ValueException("You can only compare urls with urls.",
-                             *this->getTokens());
+    return NULL;
   }
 }
 BooleanValue* UrlValue::equals(const Value& v) const {
@@ -112,8 +115,7 @@ BooleanValue* UrlValue::equals(const Value& v) const {
     return new BooleanValue(false == b->getValue());
   
   } else {
-    throw new ValueException("You can only compare urls with urls.",
-                             *this->getTokens());
+    return NULL;
   }
 }
 
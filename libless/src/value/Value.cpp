@@ -27,6 +27,9 @@ BooleanValue* Value::equals(const Value& v) const {
 BooleanValue* Value::greaterThan(const Value& v) const {
   BooleanValue* ret = this->equals(v);
 
+  if (ret == NULL)
+    return NULL;
+
   if (ret->getValue()) {
     ret->setValue(false);
     return ret;
@@ -34,14 +37,15 @@ BooleanValue* Value::greaterThan(const Value& v) const {
   delete ret;
 
   ret = this->lessThan(v);
-  ret->setValue(!ret->getValue());
+  if (ret != NULL)
+    ret->setValue(!ret->getValue());
 
   return ret;
 }
 BooleanValue* Value::lessThanEquals(const Value& v) const {
   BooleanValue* ret = this->equals(v);
 
-  if (ret->getValue())
+  if (ret == NULL || ret->getValue())
     return ret;
 
   delete ret;
@@ -52,13 +56,14 @@ BooleanValue* Value::lessThanEquals(const Value& v) const {
 BooleanValue* Value::greaterThanEquals(const Value& v) const {
   BooleanValue* ret = this->equals(v);
 
-  if (ret->getValue())
+  if (ret == NULL || ret->getValue())
     return ret;
 
   delete ret;
 
   ret = this->lessThan(v);
-  ret->setValue(!ret->getValue());
+  if (ret != NULL)
+    ret->setValue(!ret->getValue());
   return ret;
 }
 
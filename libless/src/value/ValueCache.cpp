@@ -0,0 +1,124 @@
+#include "less/value/ValueCache.h"
+#include "less/value/Value.h"
+#include "less/value/ValueScope.h"
+
+ValueCache::Entry::Entry() : value(NULL), failed(false) {
+}
+
+ValueCache::Entry::~Entry() {
+  delete value;
+}
+
+ValueCache::ValueCache() : generation(0) {
+}
+
+ValueCache::~ValueCache() {
+}
+
+void ValueCache::setGeneration(unsigned int generation) {
+  if (this->generation == generation)
+    return;
+  this->generation = generation;
+  tokens.clear();
+  values.clear();
+}
+
+void ValueCache::addLookup(const Symbol &key, const TokenList *value) {
+  std::vector<Evaluation>::iterator it;
+
+  if (evaluations.empty())
+    return;
+
+  if (key.isNull()) {
+    for (it = evaluations.begin(); it != evaluations.end(); it++)
+      it->cacheable = false;
+  } else
+    lookups.push_back(Lookup(key, value));
+}
+
+void ValueCache::begin() {
+  Evaluation e;
+
+  e.start = lookups.size();
+  e.cacheable = true;
+  evaluations.push_back(e);
+}
+
+void ValueCache::abort() {
+  lookups.resize(evaluations.back().start);
+  evaluations.pop_back();
+}
+
+bool ValueCache::validate(const Entry &entry, const ValueScope &scope) {
+  std::vector<Lookup>::const_iterator it;
+
+  for (it = entry.lookups.begin(); it != entry.lookups.end(); it++) {
+    if (scope.getVariable(it->first) != it->second)
+      return false;
+  }
+  return true;
+}
+
+ValueCache::Entry *ValueCache::end(
+    std::unordered_map<const TokenList *, Entry> &map,
+    const TokenList &variable) {
+  Evaluation e = evaluations.back();
+  Entry *entry;
+
+  evaluations.pop_back();
+  if (e.cacheable) {
+    entry = &map[&variable];
+    entry->lookups.assign(lookups.begin() + e.start, lookups.end());
+  } else
+    entry = NULL;
+
+  // the lookups stay on the stack for the value this one is nested in
+  if (evaluations.empty())
+    lookups.clear();
+  return entry;
+}
+
+const TokenList *ValueCache::getTokens(const TokenList &variable,
+                                       const ValueScope &scope) {
+  std::unordered_map<const TokenList *, Entry>::iterator it;
+
+  if ((it = tokens.find(&variable)) == tokens.end() ||
+      !validate(it->second, scope))
+    return NULL;
+  return &it->second.tokens;
+}
+
+void ValueCache::putTokens(const TokenList &variable,
+                           const TokenList &tokens) {
+  Entry *entry = end(this->tokens, variable);
+
+  if (entry != NULL)
+    entry->tokens = tokens;
+}
+
+bool ValueCache::getValue(const TokenList &variable,
+                          const ValueScope &scope,
+                          Value *&value,
+                          bool &failed) {
+  std::unordered_map<const TokenList *, Entry>::iterator it;
+
+  if ((it = values.find(&variable)) == values.end() ||
+      !validate(it->second, scope))
+    return false;
+
+  value = (it->second.value != NULL) ? it->second.value->clone() : NULL;
+  failed = it->second.failed;
+  return true;
+}
+
+void ValueCache::putValue(const TokenList &variable,
+                          const Value *value,
+                          bool failed) {
+  Entry *entry = end(values, variable);
+
+  if (entry == NULL)
+    return;
+  delete entry->value;
+  entry->value = (value != NULL) ? value->clone() : NULL;
+  entry->failed = failed;
+}
@@ -1,23 +1,58 @@
 #include "less/value/ValueProcessor.h"
+#include "less/SymbolTable.h"
+
+/**
+ * The scope of values that do not refer to variables.
+ */
+class EmptyScope : public ValueScope {
+public:
+  virtual const TokenList *getVariable(const std::string &key) const {
+    (void)key;
+    return NULL;
+  }
+};
 
-ValueProcessor::ValueProcessor() {
-  NumberValue::loadFunctions(functionLibrary);
-  Color::loadFunctions(functionLibrary);
-  StringValue::loadFunctions(functionLibrary);
-  UrlValue::loadFunctions(functionLibrary);
+ValueProcessor::ValueProcessor()
+    : functionLibrary(&getFunctionLibrary()), strict(false) {
+}
+ValueProcessor::ValueProcessor(bool strict)
+    : functionLibrary(&getFunctionLibrary()), strict(strict) {
 }
 ValueProcessor::~ValueProcessor() {
 }
 
+static FunctionLibrary *createFunctionLibrary() {
+  FunctionLibrary *library = new FunctionLibrary();
+  // the library is shared by all compilations.
+  SymbolTable::Scope scope(SymbolTable::getGlobal());
+
+  NumberValue::loadFunctions(*library);
+  Color::loadFunctions(*library);
+  StringValue::loadFunctions(*library);
+  UrlValue::loadFunctions(*library);
+  return library;
+}
+
+const FunctionLibrary &ValueProcessor::getFunctionLibrary() {
+  static const FunctionLibrary *library = createFunctionLibrary();
+  return *library;
+}
+
+// created before main, so the function names are in the global symbol
+// table before a compilation interns them in its own table.
+static const FunctionLibrary &builtinFunctions =
+    ValueProcessor::getFunctionLibrary();
+
 void ValueProcessor::processValue(TokenList &value,
                                   const ValueScope &scope) const {
   TokenList::iterator i;
   TokenList newvalue;
   Value *v;
-  const TokenList *var;
+  const TokenList *var, *processed;
   TokenList variable;
   const TokenList *oldvalue = &value;
   TokenList::const_iterator i2, itmp, end;
+  bool failed;
 
   if (!needsProcessing(value)) {
     // interpolate strings
@@ -30,22 +65,21 @@ void ValueProcessor::processValue(TokenList &value,
 
   end = oldvalue->end();
   for (i2 = oldvalue->begin(); i2 != end;) {
+    failed = false;
     try {
       itmp = i2;
-      v = processStatement(itmp, end, scope);
-      i2 = itmp;
+      v = processStatement(itmp, end, scope, failed);
+      if (!failed)
+        i2 = itmp;
     } catch (ValueException *e) {
+      // an error in a function
+      delete e;
       v = NULL;
     }
 
     // add spaces between values
-    if (v != NULL || i2 != end) {
-      if (newvalue.size() == 0 || !needsSpace(newvalue.back(), false) ||
-          (v == NULL && !needsSpace(*i2, true))) {
-      } else {
-        newvalue.push_back(Token::BUILTIN_SPACE);
-      }
-    }
+    if (v != NULL || i2 != end)
+      addSpace(newvalue, (v == NULL) ? &(*i2) : NULL);
 
     if (v != NULL) {
       newvalue.insert(
@@ -54,19 +88,17 @@ void ValueProcessor::processValue(TokenList &value,
     } else if (i2 != end) {
       // variable containing a non-value.
       if ((*i2).type == Token::ATKEYWORD &&
-          (var = scope.getVariable(*i2)) != NULL) {
-        variable = *var;
-        processValue(variable, scope);
+          (var = findVariable(*i2, scope)) != NULL) {
+        processed = &processVariable(*var, scope, variable);
 
-        newvalue.insert(newvalue.end(), variable.begin(), variable.end());
+        newvalue.insert(newvalue.end(), processed->begin(), processed->end());
         i2++;
 
         // deep variable
       } else if ((var = processDeepVariable(i2, end, scope)) != NULL) {
-        variable = *var;
-        processValue(variable, scope);
+        processed = &processVariable(*var, scope, variable);
 
-        newvalue.insert(newvalue.end(), variable.begin(), variable.end());
+        newvalue.insert(newvalue.end(), processed->begin(), processed->end());
 
       } else if ((*i2).type == Token::IDENTIFIER) {
         newvalue.push_back(*i2);
@@ -113,7 +145,7 @@ bool ValueProcessor::needsProcessing(const TokenList &value) const {
         t = &(*i);
         i++;
         if (i != value.end() && (*i).type == Token::PAREN_OPEN &&
-            functionExists((*t).c_str())) {
+            functionExists(*t)) {
           return true;
         } else
           i--;
@@ -165,14 +197,29 @@ bool ValueProcessor::validateValue(TokenList::const_iterator &i,
   const BooleanValue trueVal(true);
   Value *v2;
   bool ret;
+  bool failed = false;
+  TokenList location;
+  TokenList::const_iterator start;
 
   if (i == end)
     return false;
 
   reference = &(*i);
-  v = processStatement(i, end, scope, defaultVal);
-
-  if (v == NULL) {
+  start = i;
+  v = processStatement(i, end, scope, failed, defaultVal);
+
+  if (failed) {
+    // evaluate the statement again to throw the error of the operation
+    const ValueProcessor processor(true);
+    failed = false;
+    delete processor.processStatement(start, end, scope, failed, defaultVal);
+
+    location.push_back(*reference);
+    throw new ValueException(
+        "An operation in the condition is not defined for the types of "
+        "its operands.",
+        location);
+  } else if (v == NULL) {
     throw new ParseException(*reference,
                              "condition",
                              reference->line,
@@ -189,11 +236,490 @@ bool ValueProcessor::validateValue(TokenList::const_iterator &i,
   return ret;
 }
 
+void ValueProcessor::compileCondition(Condition &condition) const {
+  const TokenList &tokens = condition.getTokens();
+  TokenList::const_iterator i = tokens.begin();
+  TokenList::const_iterator end = tokens.end();
+
+  condition.clear();
+  skipWhitespace(i, end);
+
+  if (i == end)
+    return;
+
+  if (*i == "not") {
+    condition.setNegated(true);
+    i++;
+  }
+
+  // the statements are read as validateCondition() reads them
+  while (true) {
+    condition.addStatement();
+
+    if (i != end && !compileStatement(condition, i, end)) {
+      condition.clear();
+      return;
+    }
+    skipWhitespace(i, end);
+
+    if (i == end || *i != "and")
+      break;
+    i++;
+    skipWhitespace(i, end);
+  }
+  condition.setCompiled(true);
+}
+
+bool ValueProcessor::compileStatement(Expression &expression,
+                                      TokenList::const_iterator &i,
+                                      TokenList::const_iterator &end) const {
+  bool valid = true;
+
+  skipWhitespace(i, end);
+  if (!compileConstant(expression, i, end))
+    return false;
+
+  skipWhitespace(i, end);
+  while (compileOperation(expression, i, end, OP_NONE, valid))
+    skipWhitespace(i, end);
+  return valid;
+}
+
+bool ValueProcessor::compileOperation(Expression &expression,
+                                      TokenList::const_iterator &i,
+                                      TokenList::const_iterator &end,
+                                      ValueProcessor::Operator lastop,
+                                      bool &valid) const {
+  TokenList::const_iterator tmp = i;
+  size_t index = i - expression.getTokens().begin();
+  Operator op;
+
+  if (!valid || i == end)
+    return false;
+
+  if ((op = processOperator(tmp, end)) == OP_NONE ||
+      (lastop != OP_NONE && lastop >= op))
+    return false;
+
+  i = tmp;
+  skipWhitespace(i, end);
+
+  if (!compileConstant(expression, i, end)) {
+    valid = false;
+    return false;
+  }
+
+  skipWhitespace(i, end);
+  while (compileOperation(expression, i, end, op, valid))
+    skipWhitespace(i, end);
+
+  expression.addInstruction(Expression::OPERATOR, op, index);
+  return valid;
+}
+
+bool ValueProcessor::compileConstant(Expression &expression,
+                                     TokenList::const_iterator &i,
+                                     TokenList::const_iterator &end) const {
+  TokenList::const_iterator start = i;
+  size_t index = i - expression.getTokens().begin();
+  Token token;
+  Value *value;
+  int depth;
+
+  if (i == end)
+    return false;
+
+  switch ((*i).type) {
+    case Token::NUMBER:
+    case Token::PERCENTAGE:
+    case Token::DIMENSION:
+      expression.addConstant(new NumberValue(*i));
+      i++;
+      return true;
+
+    case Token::ATKEYWORD:
+      expression.addInstruction(Expression::VARIABLE, index,
+                                expression.storeSymbol(Symbol(*i)));
+      i++;
+      return true;
+
+    case Token::HASH:
+    case Token::STRING:
+    case Token::URL:
+      i++;
+      expression.addInstruction(Expression::TOKENS, index, index + 1);
+      return true;
+
+    case Token::IDENTIFIER:
+      token = *i;
+      i++;
+
+      if (i == end || (*i).type != Token::PAREN_OPEN) {
+        if (token.compare("true") == 0)
+          value = new BooleanValue(token, true);
+        else if ((value = processUnit(token)) == NULL &&
+                 (value = Color::fromName(token)) == NULL)
+          value = new StringValue(token, false);
+        expression.addConstant(value);
+        return true;
+      }
+
+      i++;
+      if (token == "default") {
+        if (i == end || (*i).type != Token::PAREN_CLOSED)
+          return false;
+        i++;
+        expression.addInstruction(Expression::DEFAULT, index);
+        return true;
+      }
+
+      // a function call, up to the matching parenthesis
+      for (depth = 1; i != end && depth > 0; i++) {
+        if ((*i).type == Token::PAREN_OPEN)
+          depth++;
+        else if ((*i).type == Token::PAREN_CLOSED)
+          depth--;
+      }
+      if (depth > 0)
+        return false;
+      expression.addInstruction(
+          Expression::TOKENS, index, index + (i - start));
+      return true;
+
+    case Token::PAREN_OPEN:
+      i++;
+      if (!compileStatement(expression, i, end))
+        return false;
+      skipWhitespace(i, end);
+
+      if (i == end || (*i).type != Token::PAREN_CLOSED)
+        return false;
+      i++;
+      expression.addInstruction(Expression::LOCATION, index);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+bool ValueProcessor::validateCondition(const Condition &condition,
+                                       const ValueScope &scope,
+                                       bool defaultVal) const {
+  std::vector<Condition::Statement>::const_iterator it;
+  const std::vector<Condition::Statement> &statements =
+      condition.getStatements();
+  const BooleanValue trueVal(true);
+  BooleanValue *b;
+  Value *v;
+  bool ret = false;
+
+  if (!condition.isCompiled())
+    return validateCondition(condition.getTokens(), scope, defaultVal);
+
+  for (it = statements.begin(); it != statements.end(); it++) {
+    if (it->empty()) {
+      ret = false;
+      break;
+    }
+    if ((v = evaluateStatement(condition, *it, scope, defaultVal)) == NULL)
+      return validateCondition(condition.getTokens(), scope, defaultVal);
+
+    b = v->equals(trueVal);
+    ret = b->getValue();
+    delete b;
+    delete v;
+    if (!ret)
+      break;
+  }
+  return condition.isNegated() ? !ret : ret;
+}
+
+void ValueProcessor::compileValue(CompiledValue &value) const {
+  const TokenList &tokens = value.getTokens();
+  TokenList::const_iterator i = tokens.begin();
+  TokenList::const_iterator end = tokens.end();
+  const EmptyScope scope;
+  size_t index, statement;
+  Value *v;
+
+  value.clear();
+  if (!needsProcessing(tokens)) {
+    value.setCompiled(true);
+    return;
+  }
+
+  // the segments are read as processValue() reads them
+  while (true) {
+    skipWhitespace(i, end);
+    if (i == end)
+      break;
+    index = i - tokens.begin();
+
+    if (isLiteral(i, end)) {
+      i++;
+      value.addSegment(CompiledValue::LITERAL, index, index + 1);
+      continue;
+    }
+
+    switch ((*i).type) {
+      case Token::IDENTIFIER:
+        if (i + 1 != end && (*(i + 1)).type == Token::PAREN_OPEN &&
+            *i != "default" && !functionExists(*i)) {
+          // not a LESS function; the name and the parenthesis are copied
+          i += 2;
+          value.addSegment(CompiledValue::LITERAL, index, index + 2);
+          continue;
+        }
+        // fall through
+      case Token::HASH:
+      case Token::NUMBER:
+      case Token::PERCENTAGE:
+      case Token::DIMENSION:
+      case Token::ATKEYWORD:
+      case Token::STRING:
+      case Token::URL:
+      case Token::PAREN_OPEN:
+        value.addStatement();
+        if (!compileStatement(value, i, end)) {
+          value.clear();
+          return;
+        }
+        statement = value.getStatements().size() - 1;
+
+        // fold statements that do not refer to the scope
+        v = NULL;
+        if (isStatic(tokens.begin() + index, i)) {
+          try {
+            v = evaluateStatement(
+                value, value.getStatements()[statement], scope, false);
+          } catch (LessException *e) {
+            delete e;
+          }
+        }
+        if (v != NULL) {
+          value.addSegment(CompiledValue::CONSTANT,
+                           value.storeConstant(v),
+                           i - tokens.begin());
+        } else {
+          value.addSegment(
+              CompiledValue::STATEMENT, statement, i - tokens.begin());
+        }
+        continue;
+
+      default:
+        break;
+    }
+
+    // deep variables, format functions, escapes and negations
+    if (*i == "@" || *i == "%" || *i == "~" || *i == "-") {
+      value.clear();
+      return;
+    }
+    i++;
+    value.addSegment(CompiledValue::LITERAL, index, index + 1);
+  }
+  value.setCompiled(true);
+}
+
+bool ValueProcessor::isStatic(const TokenList &value) const {
+  return isStatic(value.begin(), value.end());
+}
+
+bool ValueProcessor::isStatic(TokenList::const_iterator i,
+                              TokenList::const_iterator end) const {
+  for (; i != end; i++) {
+    if ((*i).type == Token::ATKEYWORD ||
+        (((*i).type == Token::STRING || (*i).type == Token::URL) &&
+         (*i).find("@{") != string::npos))
+      return false;
+  }
+  return true;
+}
+
+bool ValueProcessor::processStatic(TokenList &value) const {
+  const EmptyScope scope;
+
+  try {
+    processValue(value, scope);
+  } catch (LessException *e) {
+    // the error is reported when the value is processed again
+    delete e;
+    return false;
+  }
+  return true;
+}
+
+bool ValueProcessor::isLiteral(TokenList::const_iterator i,
+                               TokenList::const_iterator end) const {
+  TokenList::const_iterator next = i + 1;
+  Color *color;
+
+  switch ((*i).type) {
+    case Token::IDENTIFIER:
+      if (next != end && (*next).type == Token::PAREN_OPEN)
+        return false;
+      break;
+
+    case Token::HASH:
+      try {
+        color = new Color(*i);
+        delete color;
+      } catch (ValueException *e) {
+        delete e;
+        return false;
+      }
+      break;
+
+    case Token::NUMBER:
+    case Token::PERCENTAGE:
+    case Token::DIMENSION:
+      break;
+
+    default:
+      return false;
+  }
+
+  skipWhitespace(next, end);
+  return next == end || processOperator(next, end) == OP_NONE;
+}
+
+void ValueProcessor::processValue(const CompiledValue &value,
+                                  TokenList &result,
+                                  const ValueScope &scope) const {
+  const TokenList &tokens = value.getTokens();
+  const std::vector<CompiledValue::Segment> &segments = value.getSegments();
+  std::vector<CompiledValue::Segment>::const_iterator it;
+  const Expression::Statement *statement;
+  const TokenList *constant;
+  TokenList::iterator i;
+  Value *v;
+
+  if (!value.isCompiled()) {
+    result = tokens;
+    processValue(result, scope);
+    return;
+  }
+  if (segments.empty()) {
+    result = tokens;
+    // interpolate strings
+    for (i = result.begin(); i != result.end(); i++) {
+      if ((*i).type == Token::STRING)
+        interpolate((*i), scope);
+    }
+    return;
+  }
+
+  result.clear();
+  result.reserve(tokens.size());
+  for (it = segments.begin(); it != segments.end(); it++) {
+    if (it->kind == CompiledValue::LITERAL) {
+      addSpace(result, &tokens[it->index]);
+      result.insert(result.end(),
+                    tokens.begin() + it->index,
+                    tokens.begin() + it->end);
+      continue;
+    } else if (it->kind == CompiledValue::CONSTANT) {
+      constant = value.getConstant(it->index).getTokens();
+      addSpace(result, NULL);
+      result.insert(result.end(), constant->begin(), constant->end());
+      continue;
+    }
+
+    statement = &value.getStatements()[it->index];
+    try {
+      v = evaluateStatement(value, *statement, scope, false);
+    } catch (ValueException *e) {
+      // an error in a function
+      delete e;
+      v = NULL;
+    }
+    if (v == NULL) {
+      result = tokens;
+      processValue(result, scope);
+      return;
+    }
+    addSpace(result, NULL);
+    result.insert(result.end(), v->getTokens()->begin(), v->getTokens()->end());
+    delete v;
+  }
+}
+
+Value *ValueProcessor::evaluateStatement(
+    const Expression &expression,
+    const Expression::Statement &statement,
+    const ValueScope &scope,
+    bool defaultVal) const {
+  const TokenList &tokens = expression.getTokens();
+  Expression::Statement::const_iterator it;
+  std::vector<Value *> stack;
+  std::vector<Value *>::iterator s;
+  TokenList::const_iterator i, end = tokens.end();
+  const TokenList *var;
+  Value *v = NULL, *operand2;
+  bool failed = false;
+
+  for (it = statement.begin(); it != statement.end(); it++) {
+    switch (it->code) {
+      case Expression::CONSTANT:
+        v = expression.getConstant(it->index).clone();
+        break;
+
+      case Expression::VARIABLE:
+        if ((var = scope.getVariable(expression.getSymbol(it->end))) != NULL)
+          v = processVariableStatement(*var, scope, failed);
+        else
+          v = NULL;
+        break;
+
+      case Expression::DEFAULT:
+        v = new BooleanValue(tokens[it->index], defaultVal);
+        break;
+
+      case Expression::TOKENS:
+        i = tokens.begin() + it->index;
+        v = processConstant(i, end, scope, failed, defaultVal);
+        if (v != NULL && i != tokens.begin() + it->end) {
+          delete v;
+          v = NULL;
+        }
+        break;
+
+      case Expression::OPERATOR:
+        operand2 = stack.back();
+        stack.pop_back();
+        v = applyOperator((Operator)it->index, *stack.back(), *operand2);
+        if (v != NULL)
+          v->setLocation(tokens[it->end]);
+        delete operand2;
+        delete stack.back();
+        stack.pop_back();
+        break;
+
+      case Expression::LOCATION:
+        v = stack.back();
+        stack.pop_back();
+        v->setLocation(tokens[it->index]);
+        break;
+    }
+
+    if (v == NULL || failed) {
+      delete v;
+      for (s = stack.begin(); s != stack.end(); s++)
+        delete *s;
+      return NULL;
+    }
+    stack.push_back(v);
+  }
+  return stack.back();
+}
+
 Value *ValueProcessor::processStatement(const TokenList &tokens,
-                                        const ValueScope &scope) const {
+                                        const ValueScope &scope,
+                                        bool &failed) const {
   TokenList::const_iterator i = tokens.begin();
   TokenList::const_iterator end = tokens.end();
-  Value *ret = processStatement(i, end, scope);
+  Value *ret = processStatement(i, end, scope, failed);
 
   if (i != end)
     return NULL;
@@ -203,22 +729,28 @@ Value *ValueProcessor::processStatement(const TokenList &tokens,
 Value *ValueProcessor::processStatement(TokenList::const_iterator &i,
                                         TokenList::const_iterator &end,
                                         const ValueScope &scope,
+                                        bool &failed,
                                         bool defaultVal) const {
   Value *op, *v;
 
   skipWhitespace(i, end);
-  v = processConstant(i, end, scope, defaultVal);
+  v = processConstant(i, end, scope, failed, defaultVal);
 
   if (v != NULL) {
     skipWhitespace(i, end);
 
-    while ((op = processOperation(i, end, *v, scope, OP_NONE, defaultVal)) != NULL) {
+    while ((op = processOperation(
+                i, end, *v, scope, OP_NONE, failed, defaultVal)) != NULL) {
       delete v;
       v = op;
 
       skipWhitespace(i, end);
     }
 
+    if (failed) {
+      delete v;
+      return NULL;
+    }
     return v;
   } else
     return NULL;
@@ -229,6 +761,7 @@ Value *ValueProcessor::processOperation(TokenList::const_iterator &i,
                                         const Value &operand1,
                                         const ValueScope &scope,
                                         ValueProcessor::Operator lastop,
+                                        bool &failed,
                                         bool defaultVal) const {
   TokenList::const_iterator tmp;
   const Value *operand2;
@@ -249,9 +782,11 @@ Value *ValueProcessor::processOperation(TokenList::const_iterator &i,
   i = tmp;
   skipWhitespace(i, end);
 
-  operand2 = processConstant(i, end, scope, defaultVal);
+  operand2 = processConstant(i, end, scope, failed, defaultVal);
   if (operand2 == NULL) {
-    if (i == end)
+    if (failed)
+      return NULL;
+    else if (i == end)
       throw new ParseException("end of line",
                                "Constant or @-variable",
                                opToken->line,
@@ -264,32 +799,31 @@ Value *ValueProcessor::processOperation(TokenList::const_iterator &i,
 
   skipWhitespace(i, end);
 
-  while ((result = processOperation(i, end, *operand2, scope, op, defaultVal))) {
+  while ((result = processOperation(
+              i, end, *operand2, scope, op, failed, defaultVal))) {
     delete operand2;
     operand2 = result;
 
     skipWhitespace(i, end);
   }
 
-  if (op == OP_ADD)
-    result = operand1.add(*operand2);
-  else if (op == OP_SUBSTRACT)
-    result = operand1.substract(*operand2);
-  else if (op == OP_MULTIPLY)
-    result = operand1.multiply(*operand2);
-  else if (op == OP_DIVIDE)
-    result = operand1.divide(*operand2);
-  else if (op == OP_EQUALS)
-    result = operand1.equals(*operand2);
-  else if (op == OP_LESS)
-    result = operand1.lessThan(*operand2);
-  else if (op == OP_GREATER)
-    result = operand1.greaterThan(*operand2);
-  else if (op == OP_LESS_EQUALS)
-    result = operand1.lessThanEquals(*operand2);
-  else if (op == OP_GREATER_EQUALS)
-    result = operand1.greaterThanEquals(*operand2);
+  if (failed) {
+    delete operand2;
+    return NULL;
+  }
+
+  result = applyOperator(op, operand1, *operand2);
 
+  if (result == NULL) {
+    try {
+      operationFailed(op, operand1, *operand2, failed);
+    } catch (...) {
+      delete operand2;
+      throw;
+    }
+    delete operand2;
+    return NULL;
+  }
   delete operand2;
   result->setLocation(*opToken);
   return result;
@@ -333,6 +867,121 @@ ValueProcessor::Operator ValueProcessor::processOperator(
     return OP_NONE;
 }
 
+Value *ValueProcessor::applyOperator(ValueProcessor::Operator op,
+                                     const Value &operand1,
+                                     const Value &operand2) const {
+  if (op == OP_ADD)
+    return operand1.add(operand2);
+  else if (op == OP_SUBSTRACT)
+    return operand1.substract(operand2);
+  else if (op == OP_MULTIPLY)
+    return operand1.multiply(operand2);
+  else if (op == OP_DIVIDE)
+    return operand1.divide(operand2);
+  else if (op == OP_EQUALS)
+    return operand1.equals(operand2);
+  else if (op == OP_LESS)
+    return operand1.lessThan(operand2);
+  else if (op == OP_GREATER)
+    return operand1.greaterThan(operand2);
+  else if (op == OP_LESS_EQUALS)
+    return operand1.lessThanEquals(operand2);
+  else if (op == OP_GREATER_EQUALS)
+    return operand1.greaterThanEquals(operand2);
+  else
+    return NULL;
+}
+
+void ValueProcessor::operationFailed(ValueProcessor::Operator op,
+                                     const Value &operand1,
+                                     const Value &operand2,
+                                     bool &failed) const {
+  const Value *reference = &operand1;
+  const char *message = "Unsupported type.";
+  bool compare = (op == OP_EQUALS || op == OP_LESS || op == OP_GREATER ||
+                  op == OP_LESS_EQUALS || op == OP_GREATER_EQUALS);
+
+  if (!strict) {
+    failed = true;
+    return;
+  }
+
+  switch (operand1.type) {
+    case Value::NUMBER:
+    case Value::PERCENTAGE:
+    case Value::DIMENSION:
+      if (compare)
+        message = "You can only compare a number with a *number*.";
+      else if (op == OP_SUBSTRACT)
+        message = "You can only substract a *number* from a number.";
+      else if (op == OP_DIVIDE)
+        message = "You can only divide a number by a *number*.";
+      else if (op == OP_MULTIPLY && operand2.type == Value::STRING) {
+        // the string multiplies itself
+        message = "Strings can only be multiplied by a number.";
+        reference = &operand2;
+      }
+      break;
+
+    case Value::COLOR:
+      if (compare)
+        message = "You can only compare a color with a *color*.";
+      else if (op == OP_ADD)
+        message = "You can only add colors with other colors, numbers or "
+          "strings.";
+      else if (op == OP_SUBSTRACT)
+        message = "You can only substract a color or a number from a color.";
+      else if (op == OP_MULTIPLY)
+        message = "You can only multiply a color by a color or a number.";
+      else
+        message = "You can only divide a color by a color or a number.";
+      break;
+
+    case Value::STRING:
+      if (compare)
+        message = "You can only compare a string with a *string*.";
+      else if (op == OP_SUBSTRACT)
+        message = "Can't substract from strings.";
+      else if (op == OP_MULTIPLY)
+        message = "Strings can only be multiplied by a number.";
+      else
+        message = "Can't divide strings.";
+      break;
+
+    case Value::BOOLEAN:
+      if (op == OP_ADD)
+        message = "Can't add boolean types.";
+      else if (op == OP_SUBSTRACT)
+        message = "Can't substract boolean types.";
+      else if (op == OP_MULTIPLY)
+        message = "Can't multiply boolean types.";
+      else
+        message = "Can't divide boolean types.";
+      break;
+
+    case Value::UNIT:
+      if (compare)
+        message = "You can only compare a unit with a *unit*.";
+      else
+        message = "Can't do math on unit types.";
+      break;
+
+    case Value::URL:
+      if (compare)
+        message = "You can only compare urls with urls.";
+      else if (op == OP_ADD)
+        message = "You can not add urls.";
+      else if (op == OP_SUBSTRACT)
+        message = "You can not substract urls.";
+      else if (op == OP_MULTIPLY)
+        message = "You can not multiply urls.";
+      else
+        message = "You can not divide urls.";
+      break;
+  }
+  throw new ValueException(message, *reference->getTokens());
+}
+
 const char *ValueProcessor::operatorToString(ValueProcessor::Operator o) const {
   switch (o) {
     case OP_EQUALS:
@@ -362,11 +1011,11 @@ const char *ValueProcessor::operatorToString(ValueProcessor::Operator o) const {
 Value *ValueProcessor::processConstant(TokenList::const_iterator &i,
                                        TokenList::const_iterator &end,
                                        const ValueScope &scope,
+                                       bool &failed,
                                        bool defaultVal) const {
   Token token;
   Value *ret;
   const TokenList *var;
-  TokenList variable;
   bool hasQuotes;
   std::string str;
 
@@ -388,10 +1037,8 @@ Value *ValueProcessor::processConstant(TokenList::const_iterator &i,
       return new NumberValue(token);
 
     case Token::ATKEYWORD:
-      if ((var = scope.getVariable(token)) != NULL) {
-        variable = *var;
-
-        ret = processStatement(variable, scope);
+      if ((var = findVariable(token, scope)) != NULL) {
+        ret = processVariableStatement(*var, scope, failed);
 
         if (ret != NULL) {
           i++;
@@ -422,16 +1069,19 @@ Value *ValueProcessor::processConstant(TokenList::const_iterator &i,
       if (i != end && (*i).type == Token::PAREN_OPEN) {
         if (token == "default") {
           i++;
+          if (i == end)
+            throw new ParseException("end of value", ")", 0, 0, "");
           if ((*i).type != Token::PAREN_CLOSED) {
             throw new ParseException(*i,
                                      ")",
                                      (*i).line, (*i).column, (*i).source);
           }
+          i++;
           return new BooleanValue(token, defaultVal);
-        } else if (functionExists(token.c_str())) {
+        } else if (functionExists(token)) {
           i++;
 
-          ret = processFunction(token, i, end, scope);
+          ret = processFunction(token, i, end, scope, failed);
           if (ret == NULL) {
             i--;
             i--;
@@ -455,15 +1105,14 @@ Value *ValueProcessor::processConstant(TokenList::const_iterator &i,
       }
 
     case Token::PAREN_OPEN:
-      return processSubstatement(i, end, scope, defaultVal);
+      return processSubstatement(i, end, scope, failed, defaultVal);
 
     default:
       break;
   }
 
   if ((var = processDeepVariable(i, end, scope)) != NULL) {
-    variable = *var;
-    ret = processStatement(variable, scope);
+    ret = processVariableStatement(*var, scope, failed);
     if (ret != NULL) {
       //ret->setLocation(token);
     }
@@ -474,8 +1123,10 @@ Value *ValueProcessor::processConstant(TokenList::const_iterator &i,
     if (i != end && (*i).type == Token::PAREN_OPEN) {
       i++;
 
-      if ((ret = processFunction(token, i, end, scope)) != NULL)
+      if ((ret = processFunction(token, i, end, scope, failed)) != NULL)
         return ret;
+      else if (failed)
+        return NULL;
 
       i--;
     }
@@ -483,7 +1134,7 @@ Value *ValueProcessor::processConstant(TokenList::const_iterator &i,
   }
   if ((ret = processEscape(i, end, scope)) != NULL) {
     return ret;
-  } else if ((ret = processNegative(i, end, scope)) != NULL) {
+  } else if ((ret = processNegative(i, end, scope, failed)) != NULL) {
     return ret;
   }
   return NULL;
@@ -492,6 +1143,7 @@ Value *ValueProcessor::processConstant(TokenList::const_iterator &i,
 Value *ValueProcessor::processSubstatement(TokenList::const_iterator &i,
                                            TokenList::const_iterator &end,
                                            const ValueScope &scope,
+                                           bool &failed,
                                            bool defaultVal) const {
   Value *ret;
   TokenList::const_iterator i2 = i;
@@ -501,7 +1153,7 @@ Value *ValueProcessor::processSubstatement(TokenList::const_iterator &i,
 
   i2++;
 
-  ret = processStatement(i2, end, scope, defaultVal);
+  ret = processStatement(i2, end, scope, failed, defaultVal);
 
   if (ret == NULL)
     return NULL;
@@ -522,12 +1174,67 @@ Value *ValueProcessor::processSubstatement(TokenList::const_iterator &i,
   return ret;
 }
 
+const TokenList &ValueProcessor::processVariable(const TokenList &variable,
+                                                 const ValueScope &scope,
+                                                 TokenList &buffer) const {
+  ValueCache *cache = scope.getValueCache();
+  const TokenList *ret;
+
+  if (cache == NULL) {
+    buffer = variable;
+    processValue(buffer, scope);
+    return buffer;
+  }
+
+  if ((ret = cache->getTokens(variable, scope)) != NULL)
+    return *ret;
+
+  buffer = variable;
+  cache->begin();
+  try {
+    processValue(buffer, scope);
+  } catch (...) {
+    cache->abort();
+    throw;
+  }
+  cache->putTokens(variable, buffer);
+  return buffer;
+}
+
+Value *ValueProcessor::processVariableStatement(const TokenList &variable,
+                                                const ValueScope &scope,
+                                                bool &failed) const {
+  ValueCache *cache = scope.getValueCache();
+  Value *ret;
+  bool f = false;
+
+  if (cache == NULL || strict)
+    return processStatement(variable, scope, failed);
+
+  if (!cache->getValue(variable, scope, ret, f)) {
+    cache->begin();
+    try {
+      ret = processStatement(variable, scope, f);
+    } catch (...) {
+      cache->abort();
+      throw;
+    }
+    cache->putValue(variable, ret, f);
+  }
+
+  if (f)
+    failed = true;
+  return ret;
+}
+
 const TokenList *ValueProcessor::processDeepVariable(
     TokenList::const_iterator &i,
     TokenList::const_iterator &end,
     const ValueScope &scope) const {
   const TokenList *var;
   TokenList variable;
+  const TokenList *processed;
+  Token name;
   std::string key = "@";
 
   if (i == end || (*i).type != Token::OTHER || (*i) != "@")
@@ -536,35 +1243,49 @@ const TokenList *ValueProcessor::processDeepVariable(
   i++;
 
   if (i == end || (*i).type != Token::ATKEYWORD ||
-      (var = scope.getVariable((*i))) == NULL) {
+      (var = findVariable(*i, scope)) == NULL) {
     i--;
     return NULL;
   }
 
-  variable = *var;
-  processValue(variable, scope);
+  processed = &processVariable(*var, scope, variable);
 
-  if (variable.size() != 1 || variable.front().type != Token::STRING) {
+  if (processed->size() != 1 || processed->front().type != Token::STRING) {
     i--;
     return NULL;
   }
 
   i++;
   // generate key with '@' + var without quotes
-  variable.front().removeQuotes();
-  key.append(variable.front());
+  name = processed->front();
+  name.removeQuotes();
+  key.append(name);
 
   return scope.getVariable(key);
 }
 
-bool ValueProcessor::functionExists(const char *function) const {
-  return ((functionLibrary.getFunction(function)) != NULL);
+bool ValueProcessor::functionExists(const Token &function) const {
+  if (function.getSymbol().isNull())
+    return (functionLibrary->getFunction(function.c_str()) != NULL);
+  return (functionLibrary->getFunction(function.getSymbol()) != NULL);
+}
+
+const TokenList *ValueProcessor::findVariable(const Token &token,
+                                              const ValueScope &scope) const {
+  const Symbol &symbol = token.getSymbol();
+
+  // a token that was not read by the tokenizer, or was changed since, is
+  // looked up by its string.
+  if (symbol.isNull())
+    return scope.getVariable(token);
+  return scope.getVariable(symbol);
 }
 
 Value *ValueProcessor::processFunction(const Token &function,
                                        TokenList::const_iterator &i,
                                        TokenList::const_iterator &end,
-                                       const ValueScope &scope) const {
+                                       const ValueScope &scope,
+                                       bool &failed) const {
   // Use a temporary iterator so we don't disturb <code>i</code> if
   // processing fails
   TokenList::const_iterator i2 = i;
@@ -578,14 +1299,16 @@ Value *ValueProcessor::processFunction(const Token &function,
   
   std::ostringstream fnc_str;
   
-  fi = functionLibrary.getFunction(function.c_str());
+  fi = function.getSymbol().isNull()
+           ? functionLibrary->getFunction(function.c_str())
+           : functionLibrary->getFunction(function.getSymbol());
 
   if (fi == NULL)
     return NULL;
 
-  if (processArguments(i2, end, scope, arguments)) {
+  if (processArguments(i2, end, scope, arguments, failed)) {
     
-    if (!functionLibrary.checkArguments(fi, arguments)) {
+    if (!functionLibrary->checkArguments(fi, arguments)) {
       fnc_str << function << "(";
       for (it = arguments.begin(); it != arguments.end(); it++) {
         if (it != arguments.begin())
@@ -595,7 +1318,7 @@ Value *ValueProcessor::processFunction(const Token &function,
       }
       fnc_str << ")";
       throw new ParseException(fnc_str.str(),
-                               functionLibrary.functionDefToString(function.c_str(), fi),
+                               functionLibrary->functionDefToString(function.c_str(), fi),
                                function.line, function.column, function.source);
     }
     ret = fi->func(arguments);
@@ -616,15 +1339,18 @@ Value *ValueProcessor::processFunction(const Token &function,
 bool ValueProcessor::processArguments(TokenList::const_iterator &i,
                                       TokenList::const_iterator &end,
                                       const ValueScope &scope,
-                                      vector<const Value *> &arguments) const {
+                                      vector<const Value *> &arguments,
+                                      bool &failed) const {
   Value *argument;
 
   if (i == end)
     return false;
 
   if ((*i).type != Token::PAREN_CLOSED) {
-    argument = processStatement(i, end, scope);
-    if (argument != NULL)
+    argument = processStatement(i, end, scope, failed);
+    if (failed)
+      return false;
+    else if (argument != NULL)
       arguments.push_back(argument);
     else {
       arguments.push_back(new StringValue(*i, false));
@@ -635,9 +1361,11 @@ bool ValueProcessor::processArguments(TokenList::const_iterator &i,
   while (i != end && ((*i) == "," || (*i) == ";")) {
     i++;
 
-    argument = processStatement(i, end, scope);
+    argument = processStatement(i, end, scope, failed);
 
-    if (argument != NULL) {
+    if (failed) {
+      return false;
+    } else if (argument != NULL) {
       arguments.push_back(argument);
     } else if ((*i).type != Token::PAREN_CLOSED) {
       arguments.push_back(new StringValue(*i, false));
@@ -707,6 +1435,13 @@ bool ValueProcessor::needsSpace(const Token &t, bool before) const {
   return true;
 }
 
+void ValueProcessor::addSpace(TokenList &value, const Token *next) const {
+  if (value.size() == 0 || !needsSpace(value.back(), false) ||
+      (next != NULL && !needsSpace(*next, true)))
+    return;
+  value.push_back(Token::BUILTIN_SPACE);
+}
+
 void ValueProcessor::skipWhitespace(TokenList::const_iterator &i,
                                     TokenList::const_iterator &end) const {
   while (i != end && (*i).type == Token::WHITESPACE)
@@ -715,7 +1450,8 @@ void ValueProcessor::skipWhitespace(TokenList::const_iterator &i,
 
 Value *ValueProcessor::processNegative(TokenList::const_iterator &i,
                                        TokenList::const_iterator &end,
-                                       const ValueScope &scope) const {
+                                       const ValueScope &scope,
+                                       bool &failed) const {
   Token minus;
   Value *constant;
   Value *zero, *ret;
@@ -729,7 +1465,7 @@ Value *ValueProcessor::processNegative(TokenList::const_iterator &i,
 
   skipWhitespace(i, end);
 
-  constant = processConstant(i, end, scope);
+  constant = processConstant(i, end, scope, failed);
   if (constant == NULL) {
     i--;
     return NULL;
@@ -738,11 +1474,21 @@ Value *ValueProcessor::processNegative(TokenList::const_iterator &i,
   zero = new NumberValue(t_zero);
   ret = zero->substract(*constant);
 
-  ret->setLocation(minus);
-
+  if (ret == NULL) {
+    try {
+      operationFailed(OP_SUBSTRACT, *zero, *constant, failed);
+    } catch (...) {
+      delete constant;
+      delete zero;
+      throw;
+    }
+  }
   delete constant;
   delete zero;
 
+  if (ret == NULL)
+    return NULL;
+  ret->setLocation(minus);
   return ret;
 }
 
@@ -752,6 +1498,8 @@ void ValueProcessor::interpolate(std::string &str,
   string key, value;
   const TokenList *var;
   TokenList variable;
+  const TokenList *processed;
+  Token unquoted;
 
   while ((start = str.find("@{", end)) != string::npos &&
          (end = str.find("}", start)) != string::npos) {
@@ -761,16 +1509,15 @@ void ValueProcessor::interpolate(std::string &str,
     var = scope.getVariable(key);
 
     if (var != NULL) {
-      variable = *var;
-
-      processValue(variable, scope);
+      processed = &processVariable(*var, scope, variable);
 
       // Remove quotes off strings.
-      if (variable.size() == 1 && variable.front().type == Token::STRING) {
-        variable.front().removeQuotes();
-      }
-
-      value = variable.toString();
+      if (processed->size() == 1 && processed->front().type == Token::STRING) {
+        unquoted = processed->front();
+        unquoted.removeQuotes();
+        value = unquoted;
+      } else
+        value = processed->toString();
 
       str.replace(start, (end + 1) - start, value);
       end = start + value.length();
@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threads)
+    : next(0), queued(0), pending(0), stopping(false) {
+  unsigned int i;
+
+  if (threads == 0)
+    threads = 1;
+
+  for (i = 0; i < threads; i++)
+    queues.push_back(new Queue());
+  for (i = 0; i < threads; i++)
+    workers.push_back(std::thread(&ThreadPool::run, this, i));
+}
+
+ThreadPool::~ThreadPool() {
+  std::vector<std::thread>::iterator it;
+  std::vector<Queue*>::iterator q;
+
+  wait();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  available.notify_all();
+
+  for (it = workers.begin(); it != workers.end(); it++)
+    it->join();
+  for (q = queues.begin(); q != queues.end(); q++)
+    delete *q;
+}
+
+void ThreadPool::submit(const std::function<void()> &task) {
+  Queue* queue;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending++;
+    queue = queues[next];
+    next = (next + 1) % queues.size();
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->tasks.push_back(task);
+  }
+  {
+    // take the lock so a worker can not miss the notification between
+    // checking for work and going to sleep.
+    std::lock_guard<std::mutex> lock(mutex);
+    queued++;
+  }
+  available.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (pending > 0)
+    finished.wait(lock);
+}
+
+unsigned int ThreadPool::size() const {
+  return workers.size();
+}
+
+bool ThreadPool::take(unsigned int id, std::function<void()> &task) {
+  unsigned int i;
+  Queue* queue;
+
+  // newest task from the own queue first, then the oldest task of the
+  // other queues.
+  for (i = 0; i < queues.size(); i++) {
+    queue = queues[(id + i) % queues.size()];
+
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->tasks.empty())
+      continue;
+
+    if (i == 0) {
+      task = queue->tasks.back();
+      queue->tasks.pop_back();
+    } else {
+      task = queue->tasks.front();
+      queue->tasks.pop_front();
+    }
+    queued--;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::run(unsigned int id) {
+  std::function<void()> task;
+
+  while (true) {
+    if (take(id, task)) {
+      task();
+      task = nullptr;
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--pending == 0)
+        finished.notify_all();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (queued == 0 && !stopping)
+      available.wait(lock);
+    if (stopping && queued == 0)
+      return;
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef __clessc_ThreadPool_h__
+#define __clessc_ThreadPool_h__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed number of worker threads that run submitted tasks.
+ *
+ * Every worker has its own queue. Tasks are handed out round-robin, a
+ * worker takes tasks from the back of its own queue and, when that is
+ * empty, steals from the front of the other queues, so workers that
+ * finish early take over work from slower ones.
+ */
+class ThreadPool {
+public:
+  ThreadPool(unsigned int threads);
+
+  /**
+   * Waits for the submitted tasks and stops the workers.
+   */
+  ~ThreadPool();
+
+  void submit(const std::function<void()> &task);
+
+  /**
+   * Block until all submitted tasks have run.
+   */
+  void wait();
+
+  unsigned int size() const;
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()> > tasks;
+  };
+
+  std::vector<Queue*> queues;
+  std::vector<std::thread> workers;
+  unsigned int next;
+
+  std::mutex mutex;
+  std::condition_variable available;
+  std::condition_variable finished;
+  // tasks that are queued and not taken yet
+  std::atomic<unsigned int> queued;
+  // tasks that are queued or running
+  unsigned int pending;
+  bool stopping;
+
+  void run(unsigned int id);
+  bool take(unsigned int id, std::function<void()> &task);
+
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator=(const ThreadPool&);
+};
+
+#endif  // __clessc_ThreadPool_h__
@@ -4,16 +4,35 @@
 #include <sstream>
 #include <getopt.h>
 #include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <csignal>
 #include <exception>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
+#include <less/Arena.h>
+#include <less/SymbolTable.h>
 #include <less/less/LessTokenizer.h>
 #include <less/less/LessParser.h>
+#include <less/less/ImportCache.h>
+#include <less/less/ImportPrefetcher.h>
+#include <less/less/ParallelParser.h>
+#include <less/lessstylesheet/DependencyGraph.h>
+#include <less/css/ReplayTokenizer.h>
 #include <less/css/CssWriter.h>
 #include <less/css/CssPrettyWriter.h>
 #include <less/stylesheet/Stylesheet.h>
 #include <less/css/IOException.h>
 #include <less/lessstylesheet/LessStylesheet.h>
 
+#include "ThreadPool.h"
+
 
 using namespace std;
 
@@ -22,16 +41,25 @@ using namespace std;
  * 
  */
 
-void usage () {
-  cout <<
-    "Usage: lessc [OPTION]... [FILE]\n"
+void usage (ostream &out) {
+  out <<
+    "Usage: lessc [OPTION]... [FILE]...\n"
     "\n"
     "   FILE				Less source file. If not given, source \
 is read from stdin.\n"
+    "				More than one file can be compiled with \
+--output-dir.\n"
     "   -h, --help			Show this message and exit.\n"
     "       --version		Print the program name and version.\n"
     "\n"
     "   -o, --output=<FILE>		Send output to FILE\n"
+    "       --output-dir=<DIR>          Write the output for each FILE to \
+DIR, named after FILE with a .css extension.\n"
+    "       --manifest=<FILE>           Compile the files listed in FILE, \
+one input and output file per line.\n"
+    "   -j, --jobs=<N>                  Compile up to N files at the same \
+time, and parse a large file in parts on N threads, up to 256. 0 uses \
+one job per processor.\n"
     "   -f, --format			Format output CSS with newlines and \
 indentation. By default the output is unformatted.\n"
     "\n"
@@ -50,16 +78,24 @@ imported .less files.\n"
 file.\n"
     "   -l, --lint                      Don't generate output. Just display \
 parse errors.\n"
+    "\n"
+    "       --server=<SOCKET>           Listen for compile requests on a \
+UNIX socket.\n"
+    "                                   Imported files are kept in memory \
+between requests.\n"
+    "       --connect=<SOCKET>          Send the compile request to a \
+server instead of compiling in this process.\n"
     "\n"
     "Example:\n"
     "   lessc in.less -o out.css\n"
+    "   lessc --output-dir=css theme1.less theme2.less\n"
     "\n"
     "Report bugs to: " PACKAGE_BUGREPORT "\n"
     PACKAGE_NAME " home page: <" PACKAGE_URL ">\n";
 }
 
-void version () {
-  cout <<
+void version (ostream &out) {
+  out <<
     PACKAGE_STRING "\n"
     "Copyright 2012 Bram van der Kroef\n"
     "License: MIT License\n";
@@ -130,26 +166,29 @@ char* path_create_relative(const char* path, const char* relative) {
 }
 
 bool parseInput(LessStylesheet &stylesheet,
-                istream &in,
-                const char* source,
+                CssTokenizer &tokenizer,
                 std::list<const char*> &sources,
-                std::list<const char*> &includePaths) {
+                std::list<const char*> &includePaths,
+                ImportCache *importCache,
+                DependencyGraph *graph,
+                ostream &err) {
   std::list<const char*>::iterator i;
   
-  LessTokenizer tokenizer(in, source);
   LessParser parser(tokenizer, sources);
   parser.includePaths = &includePaths;
+  parser.importCache = importCache;
+  parser.dependencies = graph;
   
   try{
     parser.parseStylesheet(stylesheet);
   } catch(ParseException* e) {
 
-    cerr << e->getSource() << ": Line " << e->getLineNumber() << ", Column " << 
+    err << e->getSource() << ": Line " << e->getLineNumber() << ", Column " << 
       e->getColumn() << " Parse Error: " << e->what() << endl;
     
     return false;
   } catch(exception* e) {
-    cerr << " Error: " << e->what() << endl;
+    err << " Error: " << e->what() << endl;
 
     return false;
   }
@@ -158,33 +197,37 @@ bool parseInput(LessStylesheet &stylesheet,
 }
 
 bool processStylesheet (const LessStylesheet &stylesheet,
-                        Stylesheet &css) {
+                        Stylesheet &css,
+                        DependencyGraph *graph,
+                        ostream &err) {
   ProcessingContext context;
 
+  context.setDependencyGraph(graph);
   try{
     stylesheet.process(css, &context);
 
   } catch(ParseException* e) {
     
-    cerr << e->getSource() << ": Line " << e->getLineNumber() << ", Column " << 
+    err << e->getSource() << ": Line " << e->getLineNumber() << ", Column " << 
       e->getColumn() << " Parse Error: " << e->what() << endl;
     return false;
 
   } catch(LessException* e) {
 
-    cerr << e->getSource() << ": Line " << e->getLineNumber() << ", Column " << 
+    err << e->getSource() << ": Line " << e->getLineNumber() << ", Column " << 
       e->getColumn() << " Error: " << e->what() << endl;
     return false;
     
   } catch(exception* e) {
     
-    cerr << "Error: " << e->what() << endl;
+    err << "Error: " << e->what() << endl;
     return false;
   }
   return true;
 }
 
 void writeOutput(Stylesheet &css,
+                 ostream &console,
                  const char* output,
                  bool formatoutput,
                  const char* rootpath,
@@ -192,8 +235,12 @@ void writeOutput(Stylesheet &css,
                  const char* sourcemap_file,
                  const char* sourcemap_rootpath,
                  const char* sourcemap_basepath,
-                 const char* sourcemap_url) {
-  ostream* out = &cout;
+                 const char* sourcemap_url,
+                 DependencyGraph* graph) {
+  ostream* out = &console;
+  // the graph keeps the css of each statement, so it is written to a
+  // buffer first.
+  std::ostringstream buffer;
   CssWriter* writer;
   ostream* sourcemap_s = NULL;
   SourceMapWriter* sourcemap = NULL;
@@ -228,13 +275,20 @@ void writeOutput(Stylesheet &css,
 
     writer = formatoutput ? new CssPrettyWriter(*out, *sourcemap) :
       new CssWriter(*out, *sourcemap);
+  } else if (graph != NULL) {
+    writer = formatoutput ? new CssPrettyWriter(buffer) :
+      new CssWriter(buffer);
   } else {
     writer = formatoutput ? new CssPrettyWriter(*out) :
       new CssWriter(*out);
   }
   writer->rootpath = rootpath;
-      
-  css.write(*writer);
+
+  if (graph != NULL) {
+    graph->write(css, *writer, buffer);
+    *out << buffer.str();
+  } else
+    css.write(*writer);
       
   if (sourcemap != NULL) {
     if (sourcemap_url != NULL)
@@ -250,46 +304,429 @@ void writeOutput(Stylesheet &css,
       
   delete writer;
   *out << endl;
+  if (out != &console)
+    delete out;
 }
 
-void writeDependencies(const char* output, const std::list<const char*> &sources) {
+void writeDependencies(ostream &console,
+                       const char* output,
+                       const std::list<const char*> &sources) {
   std::list<const char *>::const_iterator i;
 
-  cout << output << ":";
+  console << output << ":";
 
   for (i = sources.begin(); i != sources.end(); i++) {
     if (*i != output) {
-      cout << " ";
-      cout << (*i);
+      console << " ";
+      console << (*i);
     }
   }
-  cout << endl;
+  console << endl;
 }
 
-int main(int argc, char * argv[]){
-  istream* in = &cin;
-  bool formatoutput = false;
-  char* source = NULL;
-  const char* output = "-";
+int serve(const char* path);
+int connect(const char* path, int argc, char* argv[]);
+
+/**
+ * The dependency graphs a server keeps between requests, by the key of
+ * the compilation followed by the input file. Each graph holds a parsed
+ * stylesheet and its output, so only the graphs of the MAX_GRAPHS files
+ * that were compiled last are kept.
+ */
+class GraphCache {
+public:
+  static const size_t MAX_GRAPHS = 64;
+
+  /**
+   * Get the graph of key, creating it if there is none, and mark it as
+   * the most recently used one.
+   */
+  DependencyGraph &get(const std::string &key) {
+    order.remove(key);
+    order.push_front(key);
+    return graphs[key];
+  }
+
+  /**
+   * @return the graph of key, or NULL if there is none.
+   */
+  DependencyGraph *find(const std::string &key) {
+    std::map<std::string, DependencyGraph>::iterator it = graphs.find(key);
+
+    return (it != graphs.end()) ? &it->second : NULL;
+  }
+
+  /**
+   * Remove the graphs that were used least recently until at most
+   * MAX_GRAPHS are left. No graph can be in use.
+   */
+  void trim() {
+    while (order.size() > MAX_GRAPHS) {
+      graphs.erase(order.back());
+      order.pop_back();
+    }
+  }
+
+  void clear() {
+    graphs.clear();
+    order.clear();
+  }
+
+private:
+  std::map<std::string, DependencyGraph> graphs;
+  // the keys, the most recently used first
+  std::list<std::string> order;
+};
+
+/**
+ * Options that apply to every file in a compilation. The rootpath,
+ * source map root and base paths and the include paths are created
+ * with path_create() and are deleted with the options.
+ */
+struct CompileOptions {
+  bool formatoutput;
+  bool depends;
+  bool lint;
+  const char* rootpath;
+  // "-" to write the source map next to the output file
+  const char* sourcemap_file;
+  const char* sourcemap_rootpath;
+  const char* sourcemap_basepath;
+  const char* sourcemap_url;
+  std::list<const char*> includePaths;
+  ImportCache* importCache;
+  // loads the imports ahead of the parser, if set
+  ImportPrefetcher* prefetcher;
+  // parses large input files on several threads, if set
+  ParallelParser::Executor parseExecutor;
+  // the dependency graphs of the files, by graphKey followed by the
+  // input file, if the files are compiled incrementally.
+  GraphCache* graphs;
+  std::string graphKey;
+
+  CompileOptions() : rootpath(NULL), sourcemap_rootpath(NULL),
+                     sourcemap_basepath(NULL) {
+  }
+  ~CompileOptions() {
+    std::list<const char*>::iterator it;
+
+    delete [] rootpath;
+    delete [] sourcemap_rootpath;
+    delete [] sourcemap_basepath;
+    for (it = includePaths.begin(); it != includePaths.end(); it++)
+      delete [] *it;
+  }
+
+private:
+  CompileOptions(const CompileOptions &);
+  CompileOptions &operator=(const CompileOptions &);
+};
+
+/**
+ * Compile one input file to output. The input is read from stdin if
+ * input is "-" and the css is written to out if output is "-".
+ *
+ * With an import cache the input file is read through the cache as
+ * well, so it can be scanned for imports before it is parsed.
+ */
+int compileFile(const char* input,
+                const char* output,
+                CompileOptions &options,
+                ostream &out,
+                ostream &err) {
+  InputSource* in = NULL;
+  CssTokenizer* tokenizer;
+  std::shared_ptr<const ImportCache::Entry> entry;
+  DependencyGraph* graph = NULL;
+  char* source;
+  const char* sourcemap_file = options.sourcemap_file;
+  char* tmp = NULL;
+  // names are interned in the table of the import cache, which its
+  // tokens refer to, or in a table of this compilation. The symbols are
+  // used by the parse tree, so the table is released last.
+  std::shared_ptr<SymbolTable> symbols =
+      (options.importCache != NULL) ? options.importCache->getSymbols()
+                                    : std::make_shared<SymbolTable>();
+  SymbolTable::Scope symbolScope(*symbols);
+  // the parse tree and the output stylesheet are allocated from the
+  // arena, so it is declared before them.
+  Arena arena;
+  Arena::Scope arenaScope(arena);
+  // and from the arenas of the parallel parser
+  ParallelParser parallelParser(options.parseExecutor);
   LessStylesheet stylesheet;
   std::list<const char*> sources;
+  std::list<const char*>::iterator it;
   Stylesheet css;
-  bool depends = false, lint = false;
-  char* tmp;
+  bool parsed;
+  int status = EXIT_SUCCESS;
 
-  const char* sourcemap_file = NULL;
+  if (sourcemap_file != NULL && strcmp(sourcemap_file, "-") == 0) {
+    if (strcmp(output, "-") == 0) {
+      err << "source-map option requires that \
+a file name is specified for either the source map or the css  \
+output file." << endl;
+      return EXIT_FAILURE;
+    } else {
+      tmp = new char[strlen(output) + 5];
+      sprintf(tmp, "%s.map", output);
+      sourcemap_file = tmp;
+    }
+  }
 
-  const char* sourcemap_rootpath = NULL;
-  const char* sourcemap_basepath = NULL;
-  const char* sourcemap_url = NULL;
-  const char* rootpath = NULL;
+  source = new char[std::strlen(input) + 1];
+  std::strcpy(source, input);
 
-  std::list<const char*> includePaths;
+  if (strcmp(input, "-") != 0) {
+    try {
+      if (options.importCache != NULL)
+        entry = options.importCache->get(source);
+      else
+        in = new FileInputSource(source);
+    } catch (IOException* e) {
+      err << "Error opening file: " << input << endl;
+      delete [] source;
+      delete [] tmp;
+      return EXIT_FAILURE;
+    }
+  } else
+    in = new StreamInputSource(cin);
+
+  if (entry != NULL) {
+    if (options.prefetcher != NULL)
+      options.prefetcher->prefetch(*entry, source);
+
+    if (entry->tokenized)
+      tokenizer = new ReplayTokenizer(entry->tokens, source);
+    else
+      in = new BufferInputSource(entry->contents);
+  }
+  if (in != NULL)
+    tokenizer = new LessTokenizer(*in, source);
+
+  sources.push_back(source);
+
+  // source maps refer to the tokens, which are not kept between
+  // compilations.
+  if (options.graphs != NULL && entry != NULL && sourcemap_file == NULL &&
+      !options.depends && !options.lint) {
+    graph = options.graphs->find(options.graphKey + input);
+    graph->begin(stylesheet);
+    graph->addFile(source, entry);
+  }
+
+  // the graph records the statements as they are parsed
+  parsed = options.parseExecutor && entry != NULL && entry->tokenized &&
+           graph == NULL &&
+           parallelParser.parse(entry->tokens, source, stylesheet);
+
+  if (!parsed && !parseInput(stylesheet, *tokenizer, sources,
+                             options.includePaths, options.importCache,
+                             graph, err)) {
+    status = EXIT_FAILURE;
+  } else if (options.depends) {
+    writeDependencies(out, source, sources);
+  } else if (!processStylesheet(stylesheet, css, graph, err)) {
+    status = EXIT_FAILURE;
+  } else if (!options.lint) {
+    writeOutput(css,
+                out,
+                output,
+                options.formatoutput,
+                options.rootpath,
+                sources,
+                sourcemap_file,
+                options.sourcemap_rootpath,
+                options.sourcemap_basepath,
+                options.sourcemap_url,
+                graph);
+  }
+  delete tokenizer;
+  delete in;
+  // the main source and the imported files
+  for (it = sources.begin(); it != sources.end(); it++)
+    delete [] *it;
+  delete [] tmp;
+  return status;
+}
+
+/**
+ * The output file for input in a directory: the file name of input
+ * with the extension replaced by .css.
+ */
+std::string outputFilename(const char* dir, const char* input) {
+  std::string name = input;
+  size_t pos;
+
+  if ((pos = name.rfind('/')) != std::string::npos)
+    name.erase(0, pos + 1);
+  if ((pos = name.rfind('.')) != std::string::npos && pos > 0)
+    name.erase(pos);
+  name.append(".css");
+
+  if (std::strlen(dir) > 0 && dir[std::strlen(dir) - 1] != '/')
+    name.insert(0, "/");
+  return name.insert(0, dir);
+}
+
+/**
+ * Read input and output pairs from a manifest. Each line holds an input
+ * file and an output file separated by whitespace; empty lines and
+ * lines starting with # are skipped.
+ */
+bool parseManifest(const char* manifest,
+                   std::list<std::pair<std::string, std::string> > &files,
+                   ostream &err) {
+  ifstream in(manifest);
+  std::string line, input, output;
+  unsigned int lineno = 0;
+
+  if (!in.good()) {
+    err << "Error opening manifest: " << manifest << endl;
+    return false;
+  }
+  while (getline(in, line)) {
+    std::istringstream fields(line);
+
+    lineno++;
+    input.clear();
+    output.clear();
+    if (!(fields >> input) || input[0] == '#')
+      continue;
+
+    if (!(fields >> output)) {
+      err << manifest << ": Line " << lineno <<
+        " Expected an input and an output file." << endl;
+      return false;
+    }
+    files.push_back(std::make_pair(input, output));
+  }
+  return true;
+}
+
+/**
+ * The most jobs the jobs option accepts.
+ */
+static const unsigned long MAX_JOBS = 256;
+
+/**
+ * Read the number of jobs from the jobs option. 0 selects one job per
+ * processor.
+ */
+bool parseJobs(const char* arg, unsigned int &jobs, ostream &err) {
+  unsigned long n;
+  char* end;
+
+  errno = 0;
+  n = std::strtoul(arg, &end, 10);
+  if (!isdigit((unsigned char)arg[0]) || *end != '\0') {
+    err << "The jobs option requires a number: " << arg << endl;
+    return false;
+  }
+  if (n > MAX_JOBS || errno == ERANGE) {
+    err << "The jobs option can not be more than " << MAX_JOBS << ": "
+        << arg << endl;
+    return false;
+  }
+  if (n == 0) {
+    n = std::thread::hardware_concurrency();
+    if (n == 0)
+      n = 1;
+  }
+  jobs = n;
+  return true;
+}
+
+/**
+ * Compile the files on the threads of pool. The output and messages of
+ * each file are collected and written in the order of the files.
+ */
+int compileParallel(std::list<std::pair<std::string, std::string> > &files,
+                    ThreadPool &pool,
+                    CompileOptions &options,
+                    ostream &out,
+                    ostream &err) {
+  std::list<std::pair<std::string, std::string> >::iterator it;
+  std::vector<std::ostringstream> outs(files.size()), errs(files.size());
+  std::vector<int> statuses(files.size(), EXIT_SUCCESS);
+  size_t i;
+  int status = EXIT_SUCCESS;
+
+  for (it = files.begin(), i = 0; it != files.end(); it++, i++) {
+    const char* input = it->first.c_str();
+    const char* output = it->second.c_str();
+    std::ostringstream* file_out = &outs[i];
+    std::ostringstream* file_err = &errs[i];
+    int* file_status = &statuses[i];
+
+    pool.submit([input, output, &options, file_out, file_err, file_status] {
+        try {
+          *file_status = compileFile(input, output, options,
+                                     *file_out, *file_err);
+        } catch (exception* e) {
+          *file_err << input << ": Error: " << e->what() << endl;
+          *file_status = EXIT_FAILURE;
+        }
+      });
+  }
+  pool.wait();
+
+  for (i = 0; i < files.size(); i++) {
+    out << outs[i].str();
+    err << errs[i].str();
+    if (statuses[i] != EXIT_SUCCESS)
+      status = EXIT_FAILURE;
+  }
+  return status;
+}
+
+/**
+ * Compile with the given command line arguments. Output that would go
+ * to stdout is written to out, messages to err.
+ *
+ * importCache is used for imported files and is set when the compile
+ * is requested through a server; a server can not be started or
+ * connected to from such a request. graphs is set by a server as well
+ * and keeps the dependencies of each file between requests with the
+ * same arguments, so only the statements affected by a change are
+ * processed again.
+ */
+int compile(int argc, char * argv[],
+            ostream &out,
+            ostream &err,
+            ImportCache *importCache,
+            GraphCache *graphs) {
+  CompileOptions options;
+  const char* output = NULL;
+  const char* outputdir = NULL;
+  const char* manifest = NULL;
+  const char* server = NULL;
+  const char* connect_path = NULL;
+  ImportCache batchCache;
+  std::list<std::pair<std::string, std::string> > files;
+  std::list<std::pair<std::string, std::string> >::iterator it;
+  std::set<std::string> outputs;
+  unsigned int jobs = 1;
+  char* cwd;
+  int i;
+  int status = EXIT_SUCCESS;
+
+  options.formatoutput = false;
+  options.depends = false;
+  options.lint = false;
+  options.sourcemap_file = NULL;
+  options.sourcemap_url = NULL;
+  options.importCache = importCache;
+  options.prefetcher = NULL;
+  options.graphs = graphs;
 
   static struct option long_options[] = {
     {"version",             no_argument,       0, 1},
     {"help",                no_argument,       0, 'h'},
     {"output",              required_argument, 0, 'o'},
+    {"output-dir",          required_argument, 0, 8},
+    {"manifest",            required_argument, 0, 9},
+    {"jobs",                required_argument, 0, 'j'},
     {"format",              no_argument,       0, 'f'},
     {"source-map",          optional_argument, 0, 'm'},
     {"source-map-rootpath", required_argument, 0, 2},
@@ -299,134 +736,492 @@ int main(int argc, char * argv[]){
     {"rootpath",            required_argument, 0, 4},
     {"depends",             no_argument,       0, 'M'},
     {"lint",                no_argument,       0, 'l'},
+    {"server",              required_argument, 0, 6},
+    {"connect",             required_argument, 0, 7},
     {0,0,0,0}
   };
   
   try {
     int c, option_index;
 
-    while((c = getopt_long(argc, argv, ":o:hfv:m::I:Ml", long_options, &option_index)) != -1) {
+    // start scanning from the first argument, also on repeated calls.
+    optind = 0;
+    while((c = getopt_long(argc, argv, ":o:hfv:m::I:Mlj:", long_options, &option_index)) != -1) {
       switch (c) {
       case 1:
-        version();
+        version(out);
         return EXIT_SUCCESS;
         
       case 'h':
-        usage();
+        usage(out);
         return EXIT_SUCCESS;
         
       case 'o':
         output = optarg;
         break;
+
+      case 8:
+        outputdir = optarg;
+        break;
+
+      case 9:
+        manifest = optarg;
+        break;
+
+      case 'j':
+        if (!parseJobs(optarg, jobs, err))
+          return EXIT_FAILURE;
+        break;
         
       case 'f':
-        formatoutput = true;
+        options.formatoutput = true;
         break;
         
       case 'm':
         if (optarg)
-          sourcemap_file = optarg;
+          options.sourcemap_file = optarg;
         else
-          sourcemap_file = "-";
+          options.sourcemap_file = "-";
         break;
         
       case 2:
-        sourcemap_rootpath = path_create(optarg, std::strlen(optarg));
+        delete [] options.sourcemap_rootpath;
+        options.sourcemap_rootpath = path_create(optarg, std::strlen(optarg));
         break;
         
       case 3:
-        sourcemap_basepath = path_create(optarg, std::strlen(optarg));
+        delete [] options.sourcemap_basepath;
+        options.sourcemap_basepath = path_create(optarg, std::strlen(optarg));
         break;
 
       case 5:
-        sourcemap_url = optarg;
+        options.sourcemap_url = optarg;
         break;
 
       case 'I':
-        path_parse_list(optarg, includePaths);
+        path_parse_list(optarg, options.includePaths);
         break;
 
       case 4:
-        rootpath = path_create(optarg, std::strlen(optarg));
+        delete [] options.rootpath;
+        options.rootpath = path_create(optarg, std::strlen(optarg));
         break;
 
       case 'M':
-        depends = true;
+        options.depends = true;
         break;
         
       case 'l':
-        lint = true;
+        options.lint = true;
+        break;
+
+      case 6:
+        server = optarg;
+        break;
+
+      case 7:
+        connect_path = optarg;
         break;
         
       default:
-        cerr << "Unrecognized option. " << endl;
-        usage();
+        err << "Unrecognized option. " << endl;
+        usage(out);
         return EXIT_FAILURE;
                                          
       }
     }
-    
-    if (argc - optind >= 1) {
 
-      source = new char[std::strlen(argv[optind]) + 1];
-      std::strcpy(source, argv[optind]);
-      
-      in = new ifstream(source);
-      if (in->fail() || in->bad()) {
-        cerr << "Error opening file." << endl;
+    if (importCache != NULL && (server != NULL || connect_path != NULL)) {
+      err << "The server and connect options can not be sent to a server."
+          << endl;
+      return EXIT_FAILURE;
+    } else if (server != NULL) {
+      return serve(server);
+    } else if (connect_path != NULL) {
+      return connect(connect_path, argc, argv);
+    }
+
+    if (manifest != NULL) {
+      if (!parseManifest(manifest, files, err))
         return EXIT_FAILURE;
-      }
-    }  else {
-      
-      source = new char[2];
-      std::strcpy(source, "-");
-      
     }
-    
-    if (sourcemap_file != NULL && strcmp(sourcemap_file, "-") == 0) {
-      if (strcmp(output, "-") == 0) {
-        cerr << "source-map option requires that \
-a file name is specified for either the source map or the css  \
-output file." << endl;
+    for (; optind < argc; optind++) {
+      if (outputdir != NULL)
+        files.push_back(std::make_pair(argv[optind],
+                                       outputFilename(outputdir, argv[optind])));
+      else
+        files.push_back(std::make_pair(argv[optind],
+                                       output != NULL ? output : "-"));
+    }
+
+    if (files.empty()) {
+      if (importCache != NULL) {
+        err << "A server can not read from stdin, give an input file." << endl;
         return EXIT_FAILURE;
-      } else {
-        tmp = new char[strlen(output) + 5];
-        sprintf(tmp, "%s.map", output);
-        sourcemap_file = tmp;
       }
+      files.push_back(std::make_pair("-", output != NULL ? output : "-"));
     }
-    
-    sources.push_back(source);
-    
-    if (parseInput(stylesheet, *in, source, sources, includePaths)) {
-      if (depends) {
-        writeDependencies(source, sources);
-        return EXIT_SUCCESS;
+
+    if (files.size() > 1) {
+      if (outputdir == NULL && manifest == NULL) {
+        err << "Compiling more than one file requires an output directory \
+or a manifest." << endl;
+        return EXIT_FAILURE;
+      } else if (output != NULL) {
+        err << "The output option can not be used with more than one file."
+            << endl;
+        return EXIT_FAILURE;
+      } else if (options.sourcemap_file != NULL &&
+                 strcmp(options.sourcemap_file, "-") != 0) {
+        err << "Give the source-map option without a file name to write \
+a source map next to each output file." << endl;
+        return EXIT_FAILURE;
+      }
+      for (it = files.begin(); it != files.end(); it++) {
+        if (it->second != "-" && !outputs.insert(it->second).second) {
+          err << "More than one file is compiled to " << it->second << endl;
+          return EXIT_FAILURE;
+        }
       }
+      // share the imports between the files
+      if (options.importCache == NULL)
+        options.importCache = &batchCache;
+    }
 
-      if (!processStylesheet(stylesheet, css))
+    if (graphs != NULL) {
+      if ((cwd = getcwd(NULL, 0)) == NULL) {
+        err << "Unable to get the working directory." << endl;
         return EXIT_FAILURE;
-     
-      if (lint) 
-        return EXIT_SUCCESS;
-     
-      writeOutput(css,
-                  output,
-                  formatoutput,
-                  rootpath,
-                  sources,
-                  sourcemap_file,
-                  sourcemap_rootpath,
-                  sourcemap_basepath,
-                  sourcemap_url);
-    } else
-      return EXIT_FAILURE;
-    delete [] source;
+      }
+      options.graphKey = cwd;
+      free(cwd);
+      for (i = 0; i < argc; i++)
+        options.graphKey.append("\n").append(argv[i]);
+      options.graphKey.append("\n");
+
+      // create the graphs before the files are compiled in parallel
+      for (it = files.begin(); it != files.end(); it++)
+        graphs->get(options.graphKey + it->first);
+    }
+
+    if (jobs > 1) {
+      // the pool reads and tokenizes the imports ahead of the parser, and
+      // compiles the files if there is more than one.
+      if (options.importCache == NULL)
+        options.importCache = &batchCache;
+
+      ThreadPool pool(jobs);
+      ImportPrefetcher prefetcher(*options.importCache, &options.includePaths,
+                                  [&pool](const std::function<void()> &task) {
+                                    pool.submit(task);
+                                  });
+      options.prefetcher = &prefetcher;
+      options.parseExecutor = [&pool](const std::function<void()> &task) {
+        pool.submit(task);
+      };
+
+      if (files.size() > 1) {
+        status = compileParallel(files, pool, options, out, err);
+      } else {
+        status = compileFile(files.front().first.c_str(),
+                             files.front().second.c_str(), options, out, err);
+      }
+      options.prefetcher = NULL;
+      options.parseExecutor = nullptr;
+    } else {
+      for (it = files.begin(); it != files.end(); it++) {
+        if (compileFile(it->first.c_str(), it->second.c_str(), options,
+                        out, err) != EXIT_SUCCESS)
+          status = EXIT_FAILURE;
+      }
+    }
     
   } catch (IOException* e) {
-    cerr << " Error: " << e->what() << endl;
+    err << " Error: " << e->what() << endl;
     return EXIT_FAILURE;
   }
 		
-  return EXIT_SUCCESS;
+  return status;
+}
+
+bool writeAll(int fd, const char* data, size_t length) {
+  ssize_t n;
+
+  while (length > 0) {
+    n = write(fd, data, length);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += n;
+    length -= n;
+  }
+  return true;
+}
+
+bool socketAddress(const char* path, struct sockaddr_un &addr) {
+  if (std::strlen(path) >= sizeof(addr.sun_path)) {
+    cerr << "Socket path is too long: " << path << endl;
+    return false;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strcpy(addr.sun_path, path);
+  return true;
+}
+
+/**
+ * Read a length on a line of its own from request at pos and move pos
+ * past it. Returns false if the line is not complete yet; invalid is
+ * set if it is not a number.
+ */
+bool readLength(const std::string &request, size_t &pos, size_t &length,
+                bool &invalid) {
+  size_t end = request.find('\n', pos);
+  const char* start = request.c_str() + pos;
+  char* p;
+
+  if (end == std::string::npos)
+    return false;
+
+  if (end == pos || !isdigit((unsigned char)*start)) {
+    invalid = true;
+    return false;
+  }
+  errno = 0;
+  length = std::strtoul(start, &p, 10);
+  if (p != request.c_str() + end || errno == ERANGE) {
+    invalid = true;
+    return false;
+  }
+  pos = end + 1;
+  return true;
+}
+
+/**
+ * Split a request into the strings it holds. The request starts with
+ * the number of strings and each string with its length in bytes, on
+ * lines of their own, so a string can be empty or contain newlines.
+ * Returns false if the request is not complete yet; invalid is set if
+ * it can not be read.
+ */
+bool parseRequest(const std::string &request,
+                  std::vector<std::string> &fields,
+                  bool &invalid) {
+  size_t pos = 0, count, length;
+
+  fields.clear();
+  if (!readLength(request, pos, count, invalid))
+    return false;
+
+  while (fields.size() < count) {
+    if (!readLength(request, pos, length, invalid) ||
+        request.size() - pos < length)
+      return false;
+    fields.push_back(request.substr(pos, length));
+    pos += length;
+  }
+  return true;
+}
+
+/**
+ * Append a string to a request, preceded by its length.
+ */
+void appendField(std::string &request, const std::string &field) {
+  request.append(std::to_string(field.size()));
+  request.append("\n");
+  request.append(field);
+}
+
+/**
+ * The number of names the symbol table of a server can hold before the
+ * import cache and the dependency graphs are dropped.
+ */
+static const size_t MAX_SYMBOLS = 1 << 16;
+
+/**
+ * Read a request, compile it and send the response.
+ *
+ * A request holds the working directory of the client followed by the
+ * command line arguments, in the format read by parseRequest(). The
+ * response starts with the exit status and the length of the output on
+ * separate lines, followed by the output and then the error messages.
+ */
+void handleRequest(int client,
+                   ImportCache &cache,
+                   GraphCache &graphs) {
+  std::string request;
+  char buffer[4096];
+  ssize_t n;
+  bool complete, invalid = false;
+  std::vector<std::string> fields;
+  std::vector<char*> args;
+  std::ostringstream out, err, header;
+  int status;
+  std::vector<std::string>::iterator it;
+  std::string response;
+
+  while (!(complete = parseRequest(request, fields, invalid)) && !invalid &&
+         (n = read(client, buffer, sizeof(buffer))) != 0) {
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+    request.append(buffer, n);
+  }
+
+  if (!complete) {
+    err << "Invalid request." << endl;
+    status = EXIT_FAILURE;
+  } else if (fields.empty()) {
+    err << "Empty request." << endl;
+    status = EXIT_FAILURE;
+  } else if (chdir(fields.front().c_str()) != 0) {
+    err << "Unable to change to directory " << fields.front() << endl;
+    status = EXIT_FAILURE;
+  } else {
+    args.push_back((char*)"clessc");
+    for (it = fields.begin() + 1; it != fields.end(); it++)
+      args.push_back((char*)it->c_str());
+    args.push_back(NULL);
+
+    status = compile(args.size() - 1, &args[0], out, err, &cache, &graphs);
+    graphs.trim();
+
+    // the names of files that are no longer compiled are only dropped
+    // with the cache, and the graphs refer to them.
+    if (cache.getSymbols()->size() > MAX_SYMBOLS) {
+      graphs.clear();
+      cache.clear();
+    }
+  }
+
+  header << status << "\n" << out.str().size() << "\n";
+  response = header.str() + out.str() + err.str();
+  writeAll(client, response.data(), response.size());
+}
+
+/**
+ * Listen on a UNIX socket and handle compile requests one at a time.
+ */
+int serve(const char* path) {
+  ImportCache cache;
+  GraphCache graphs;
+  struct sockaddr_un addr;
+  int fd, client;
+
+  if (!socketAddress(path, addr))
+    return EXIT_FAILURE;
+
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    cerr << "Unable to create socket: " << strerror(errno) << endl;
+    return EXIT_FAILURE;
+  }
+  unlink(path);
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    cerr << "Unable to listen on " << path << ": " << strerror(errno) << endl;
+    close(fd);
+    return EXIT_FAILURE;
+  }
+  // a client that goes away should not end the server
+  signal(SIGPIPE, SIG_IGN);
+
+  while (true) {
+    if ((client = accept(fd, NULL, NULL)) < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      cerr << "Error accepting connection: " << strerror(errno) << endl;
+      break;
+    }
+    handleRequest(client, cache, graphs);
+    close(client);
+  }
+  close(fd);
+  unlink(path);
+  return EXIT_FAILURE;
+}
+
+/**
+ * Send the arguments, except for the connect option, to a server and
+ * print its response.
+ */
+int connect(const char* path, int argc, char* argv[]) {
+  struct sockaddr_un addr;
+  int fd, status;
+  std::string request, response;
+  std::vector<std::string> fields;
+  std::vector<std::string>::iterator it;
+  char buffer[4096];
+  char* cwd;
+  ssize_t n;
+  size_t header, length;
+
+  if (!socketAddress(path, addr))
+    return EXIT_FAILURE;
+
+  if ((cwd = getcwd(NULL, 0)) == NULL) {
+    cerr << "Unable to get the working directory." << endl;
+    return EXIT_FAILURE;
+  }
+  fields.push_back(cwd);
+  free(cwd);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--connect") == 0) {
+      i++;
+      continue;
+    } else if (std::strncmp(argv[i], "--connect=", 10) == 0)
+      continue;
+    fields.push_back(argv[i]);
+  }
+
+  request.append(std::to_string(fields.size()));
+  request.append("\n");
+  for (it = fields.begin(); it != fields.end(); it++)
+    appendField(request, *it);
+
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+      ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    cerr << "Unable to connect to " << path << ": " << strerror(errno)
+         << endl;
+    if (fd >= 0)
+      close(fd);
+    return EXIT_FAILURE;
+  }
+
+  if (!writeAll(fd, request.data(), request.size())) {
+    cerr << "Error sending request: " << strerror(errno) << endl;
+    close(fd);
+    return EXIT_FAILURE;
+  }
+
+  while ((n = read(fd, buffer, sizeof(buffer))) != 0) {
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    response.append(buffer, n);
+  }
+  close(fd);
+
+  if (sscanf(response.c_str(), "%d\n%zu\n", &status, &length) != 2 ||
+      (header = response.find('\n', response.find('\n') + 1)) ==
+      std::string::npos ||
+      header + 1 + length > response.size()) {
+    cerr << "Invalid response from server." << endl;
+    return EXIT_FAILURE;
+  }
+  header++;
+  cout.write(response.data() + header, length);
+  cerr.write(response.data() + header + length,
+             response.size() - header - length);
+  return status;
+}
+
+int main(int argc, char * argv[]){
+  return compile(argc, argv, cout, cerr, NULL, NULL);
 }
@@ -0,0 +1,61 @@
+#include <cstring>
+#include <gtest/gtest.h>
+#include <less/Arena.h>
+#include <less/lessstylesheet/LessStylesheet.h>
+
+/**
+ * Objects created while an arena is current are allocated from it and
+ * can still be deleted, which runs their destructors; objects created
+ * outside a scope do not take memory from the arena.
+ */
+TEST(ArenaTest, Scope) {
+  Arena arena(1024);
+  TokenList tokens;
+  LessSelector* heap = new LessSelector();
+  size_t allocated;
+
+  tokens.push_back(Token("a", Token::IDENTIFIER, 0, 0, "-"));
+  EXPECT_EQ(0u, arena.getAllocated());
+
+  EXPECT_EQ(NULL, Arena::getCurrent());
+  {
+    Arena::Scope scope(arena);
+    LessStylesheet* stylesheet;
+    LessSelector* selector;
+
+    EXPECT_EQ(&arena, Arena::getCurrent());
+
+    stylesheet = new LessStylesheet();
+    selector = new LessSelector();
+    selector->push_back(tokens);
+    stylesheet->createLessRuleset(*selector);
+    EXPECT_LT(0u, arena.getAllocated());
+
+    delete stylesheet;
+  }
+  EXPECT_EQ(NULL, Arena::getCurrent());
+
+  allocated = arena.getAllocated();
+  delete heap;
+  heap = new LessSelector();
+  heap->push_back(tokens);
+  EXPECT_EQ(allocated, arena.getAllocated());
+  delete heap;
+}
+
+/**
+ * Allocations larger than a block and allocations that span blocks.
+ */
+TEST(ArenaTest, Blocks) {
+  Arena arena(64);
+  char* p1 = (char*)arena.allocate(8);
+  char* p2 = (char*)arena.allocate(1000);
+  char* p3 = (char*)arena.allocate(40);
+
+  memset(p1, 1, 8);
+  memset(p2, 2, 1000);
+  memset(p3, 3, 40);
+  EXPECT_EQ(1, p1[7]);
+  EXPECT_EQ(2, p2[999]);
+  EXPECT_EQ(0u, (size_t)p3 % alignof(std::max_align_t));
+}
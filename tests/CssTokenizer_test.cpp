@@ -152,3 +152,89 @@ TEST(CssTokenizerTest, StringEscape) {
   EXPECT_EQ(Token::STRING, t.readNextToken());
   EXPECT_STREQ("'string\\''", t.getToken().c_str());
 }
+
+/**
+ * Test that tokens and their locations are the same when the input is
+ * read from a memory buffer or from a stream in small chunks.
+ */
+TEST(CssTokenizerTest, InputSource) {
+  const char* css = "a {\n  color: 'red';\n}\n/* comment\n */ b";
+  istringstream in(css);
+  StreamInputSource chunked(in, 3);
+  BufferInputSource buffer(css, strlen(css));
+
+  CssTokenizer t1(chunked, "test"), t2(buffer, "test");
+  Token::Type type;
+
+  do {
+    type = t1.readNextToken();
+    ASSERT_EQ(type, t2.readNextToken());
+    EXPECT_STREQ(t2.getToken().c_str(), t1.getToken().c_str());
+    EXPECT_EQ(t2.getToken().line, t1.getToken().line);
+    EXPECT_EQ(t2.getToken().column, t1.getToken().column);
+  } while (type != Token::EOS);
+
+  // 'b' is on the fifth line
+  EXPECT_STREQ("b", t2.getToken().c_str());
+  EXPECT_EQ(4u, t2.getToken().line);
+}
+
+/**
+ * The escape character ends the input.
+ */
+TEST(CssTokenizerTest, EscapeKey) {
+  istringstream in("abc\x1b def");
+  CssTokenizer t(in, "test");
+
+  EXPECT_EQ(Token::IDENTIFIER, t.readNextToken());
+  EXPECT_STREQ("abc", t.getToken().c_str());
+  EXPECT_EQ(Token::EOS, t.readNextToken());
+}
+
+/**
+ * Test that runs of whitespace, comments and strings that are longer
+ * than a vector give the same tokens and locations with each
+ * implementation of the CharScanner.
+ */
+TEST(CssTokenizerTest, CharScanner) {
+  std::string css =
+      "a {" + std::string(40, ' ') + "\n\n" + std::string(70, '\t') +
+      "b: '" + std::string(50, 'x') + "';\n/*" + std::string(45, '*') +
+      "\n" + std::string(33, '-') + "\n*/" + std::string(20, '\n') + "c}";
+  CharScanner::Implementation picked = CharScanner::getImplementation();
+  CharScanner::Implementation implementations[] = {
+      CharScanner::SSE2, CharScanner::AVX2};
+  std::vector<Token> expected;
+  size_t i;
+
+  ASSERT_TRUE(CharScanner::setImplementation(CharScanner::SCALAR));
+  {
+    BufferInputSource buffer(css);
+    CssTokenizer t(buffer, "test");
+    while (t.readNextToken() != Token::EOS)
+      expected.push_back(t.getToken());
+  }
+
+  for (i = 0; i < 2; i++) {
+    if (!CharScanner::setImplementation(implementations[i]))
+      continue;
+
+    BufferInputSource buffer(css);
+    CssTokenizer t(buffer, "test");
+    std::vector<Token>::iterator it;
+
+    for (it = expected.begin(); it != expected.end(); it++) {
+      ASSERT_EQ(it->type, t.readNextToken());
+      EXPECT_STREQ(it->c_str(), t.getToken().c_str());
+      EXPECT_EQ(it->line, t.getToken().line);
+      EXPECT_EQ(it->column, t.getToken().column);
+    }
+    EXPECT_EQ(Token::EOS, t.readNextToken());
+  }
+  CharScanner::setImplementation(picked);
+
+  // 'c' is on the 26th line
+  EXPECT_STREQ("c", expected[expected.size() - 2].c_str());
+  EXPECT_EQ(25u, expected[expected.size() - 2].line);
+  EXPECT_EQ(0u, expected[expected.size() - 2].column);
+}
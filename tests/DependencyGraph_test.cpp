@@ -0,0 +1,103 @@
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <less/less/LessParser.h>
+#include <less/lessstylesheet/DependencyGraph.h>
+
+class DependencyGraphTest : public ::testing::Test {
+public:
+  ImportCache cache;
+
+  void writeFile(const char* filename, const char* contents) {
+    std::ofstream out(filename);
+    out << contents;
+  }
+
+  /**
+   * Compile main.less, through graph if it is not NULL.
+   */
+  std::string compile(DependencyGraph* graph) {
+    const char* source = "dependencygraph_main.less";
+    // the names in the cached tokens are interned in its table
+    SymbolTable::Scope scope(*cache.getSymbols());
+    std::shared_ptr<const ImportCache::Entry> entry = cache.get(source);
+    ReplayTokenizer tokenizer(entry->tokens, source);
+    std::list<const char*> sources;
+    std::list<const char*>::iterator it;
+    LessParser parser(tokenizer, sources);
+    LessStylesheet less;
+    Stylesheet css;
+    ProcessingContext context;
+    std::ostringstream out;
+    CssWriter writer(out);
+
+    sources.push_back(source);
+    parser.importCache = &cache;
+    parser.dependencies = graph;
+    if (graph != NULL) {
+      graph->begin(less);
+      graph->addFile(source, entry);
+    }
+    parser.parseStylesheet(less);
+
+    context.setDependencyGraph(graph);
+    less.process(css, &context);
+
+    if (graph != NULL)
+      graph->write(css, writer, out);
+    else
+      css.write(writer);
+
+    // the imported files
+    for (it = ++sources.begin(); it != sources.end(); it++)
+      delete [] *it;
+    return out.str();
+  }
+
+  virtual void TearDown() {
+    std::remove("dependencygraph_main.less");
+    std::remove("dependencygraph_a.less");
+    std::remove("dependencygraph_b.less");
+  }
+};
+
+/**
+ * Only the statements that depend on a changed file, or on the
+ * variables and mixins in it, are processed again. The output is the
+ * same as that of a full compilation.
+ */
+TEST_F(DependencyGraphTest, Reuse) {
+  DependencyGraph graph;
+
+  writeFile("dependencygraph_main.less",
+            "@import 'dependencygraph_a';\n"
+            "@import 'dependencygraph_b';\n"
+            "/* comment */\n"
+            ".main { color: @color; .mixin(); }\n"
+            ".other { width: 1px; }\n");
+  writeFile("dependencygraph_a.less", "@color: red;\n.a { color: blue; }\n");
+  writeFile("dependencygraph_b.less", ".mixin() { height: 2px; }\n.b { }\n");
+
+  EXPECT_EQ(compile(NULL), compile(&graph));
+  EXPECT_EQ(0u, graph.getReused());
+
+  EXPECT_EQ(compile(NULL), compile(&graph));
+  // all but the comment
+  EXPECT_EQ(5u, graph.getReused());
+
+  // .main uses @color, .a is in the file
+  writeFile("dependencygraph_a.less", "@color: green;\n.a { color: blue; }\n");
+  EXPECT_EQ(compile(NULL), compile(&graph));
+  EXPECT_EQ(3u, graph.getReused());
+
+  // .main uses the mixin
+  writeFile("dependencygraph_b.less", ".mixin() { height: 3px; }\n.b { }\n");
+  EXPECT_EQ(compile(NULL), compile(&graph));
+  EXPECT_EQ(2u, graph.getReused());
+
+  // an extension can change any statement
+  writeFile("dependencygraph_b.less",
+            ".mixin() { height: 3px; }\n.b:extend(.other) { }\n");
+  EXPECT_EQ(compile(NULL), compile(&graph));
+  EXPECT_EQ(0u, graph.getReused());
+}
@@ -0,0 +1,188 @@
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <gtest/gtest.h>
+#include <less/less/ImportCache.h>
+#include <less/less/ImportPrefetcher.h>
+#include <less/less/LessParser.h>
+#include <less/less/LessTokenizer.h>
+#include <less/css/ReplayTokenizer.h>
+#include <vector>
+#include "ThreadPool.h"
+
+/**
+ * Entries are read once, and read again when the file changes.
+ */
+TEST(ImportCacheTest, Invalidate) {
+  const char* filename = "importcache_test.less";
+  ImportCache cache;
+  std::ofstream out(filename);
+
+  out << "@a: 1;";
+  out.close();
+
+  std::shared_ptr<const ImportCache::Entry> entry = cache.get(filename);
+  EXPECT_EQ("@a: 1;", entry->contents);
+  EXPECT_EQ(ImportCache::hash("@a: 1;"), entry->hash);
+  EXPECT_EQ(entry, cache.get(filename));
+  EXPECT_EQ(1u, cache.size());
+
+  out.open(filename);
+  out << "@a: 22;";
+  out.close();
+
+  EXPECT_EQ("@a: 22;", cache.get(filename)->contents);
+  EXPECT_EQ(1u, cache.size());
+  // the old entry is unchanged
+  EXPECT_EQ("@a: 1;", entry->contents);
+
+  std::remove(filename);
+  EXPECT_THROW(cache.get(filename), IOException*);
+}
+
+/**
+ * The cached tokens replay the same tokens as the tokenizer, and files
+ * that fail to tokenize are not replayed.
+ */
+TEST(ImportCacheTest, Tokens) {
+  const char* filename = "importcache_test.less";
+  ImportCache cache;
+  std::ofstream out(filename);
+
+  out << ".a {\n  color: red; // comment\n}\n";
+  out.close();
+
+  std::shared_ptr<const ImportCache::Entry> entry = cache.get(filename);
+  ASSERT_TRUE(entry->tokenized);
+
+  BufferInputSource in(entry->contents);
+  LessTokenizer t1(in, "test");
+  ReplayTokenizer t2(entry->tokens, "test");
+  Token::Type type;
+
+  do {
+    type = t1.readNextToken();
+    ASSERT_EQ(type, t2.readNextToken());
+    EXPECT_EQ(t1.getToken(), t2.getToken());
+    EXPECT_EQ(t1.getToken().line, t2.getToken().line);
+    EXPECT_EQ(t1.getToken().column, t2.getToken().column);
+    EXPECT_STREQ("test", t2.getToken().source);
+  } while (type != Token::EOS);
+
+  out.open(filename);
+  out << ".a { content: 'unterminated\n}";
+  out.close();
+
+  EXPECT_FALSE(cache.get(filename)->tokenized);
+  std::remove(filename);
+}
+
+/**
+ * The names in the tokens are interned in the table of the cache, and
+ * clearing the cache starts a new table.
+ */
+TEST(ImportCacheTest, Symbols) {
+  const char* filename = "importcache_test.less";
+  ImportCache cache;
+  std::shared_ptr<SymbolTable> symbols = cache.getSymbols();
+  std::ofstream out(filename);
+
+  out << "@importcache-test: 1;";
+  out.close();
+
+  std::shared_ptr<const ImportCache::Entry> entry = cache.get(filename);
+  ASSERT_TRUE(entry->tokenized);
+  EXPECT_EQ(symbols, entry->symbols);
+  EXPECT_TRUE(Symbol::find("@importcache-test").isNull());
+  {
+    SymbolTable::Scope scope(*symbols);
+    EXPECT_EQ(Symbol::find("@importcache-test"),
+              entry->tokens.front().getSymbol());
+  }
+
+  cache.clear();
+  EXPECT_NE(symbols, cache.getSymbols());
+  EXPECT_EQ(cache.getSymbols(), cache.get(filename)->symbols);
+  std::remove(filename);
+}
+
+/**
+ * The prefetcher loads imported files, and the files they import, into
+ * the cache. Directives are understood and css files are skipped.
+ */
+TEST(ImportCacheTest, Prefetch) {
+  ImportCache cache;
+  std::vector<std::string> tasks;
+  ImportPrefetcher prefetcher(
+      cache, NULL, [&tasks](const std::function<void()> &task) {
+        tasks.push_back("task");
+        task();
+      });
+  std::ofstream out("prefetch_a.less");
+
+  out << "@import (reference, optional) 'prefetch_b';\n"
+         "@import url(prefetch_c.css);\n"
+         ".a { @import \"prefetch_b.less\"; }\n";
+  out.close();
+  out.open("prefetch_b.less");
+  out << "@import 'prefetch_a'; @import 'prefetch_missing';";
+  out.close();
+
+  prefetcher.prefetch(*cache.get("prefetch_a.less"), "prefetch_a.less");
+
+  // b is fetched once, a is fetched because b imports it and is found
+  // in the cache.
+  EXPECT_EQ(2u, tasks.size());
+  EXPECT_EQ(2u, cache.size());
+
+  std::remove("prefetch_a.less");
+  std::remove("prefetch_b.less");
+}
+
+/**
+ * A file that fails to parse before its imports leaves the prefetch
+ * tasks running on the pool; the prefetcher waits for them before it
+ * is destroyed, so each nested import is in the cache by then.
+ */
+TEST(ImportCacheTest, PrefetchParseError) {
+  ImportCache cache;
+  ThreadPool pool(4);
+  std::list<const char*> sources;
+  LessStylesheet stylesheet;
+  std::ofstream out("prefetch_error.less");
+  char name[32];
+  int i;
+
+  out << ".a { color: red; } }\n@import 'prefetch_error_0';\n";
+  out.close();
+  // each file imports the next one
+  for (i = 0; i < 100; i++) {
+    snprintf(name, sizeof(name), "prefetch_error_%d.less", i);
+    out.open(name);
+    out << "@import 'prefetch_error_" << (i + 1) % 100 << "';\n.b { c: d; }\n";
+    out.close();
+  }
+
+  {
+    ImportPrefetcher prefetcher(
+        cache, NULL, [&pool](const std::function<void()> &task) {
+          pool.submit(task);
+        });
+    std::shared_ptr<const ImportCache::Entry> entry =
+        cache.get("prefetch_error.less");
+    ReplayTokenizer tokenizer(entry->tokens, "prefetch_error.less");
+    LessParser parser(tokenizer, sources);
+
+    prefetcher.prefetch(*entry, "prefetch_error.less");
+    parser.importCache = &cache;
+    EXPECT_THROW(parser.parseStylesheet(stylesheet), ParseException*);
+  }
+  EXPECT_EQ(101u, cache.size());
+  pool.wait();
+
+  std::remove("prefetch_error.less");
+  for (i = 0; i < 100; i++) {
+    snprintf(name, sizeof(name), "prefetch_error_%d.less", i);
+    std::remove(name);
+  }
+}
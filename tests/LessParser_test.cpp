@@ -1,6 +1,7 @@
 #include <list>
 #include <gtest/gtest.h>
 #include <less/less/LessParser.h>
+#include <less/less/ParallelParser.h>
 #include <less/lessstylesheet/MixinException.h>
 
 class LessParserTest : public ::testing::Test {
@@ -346,6 +347,48 @@ TEST_F(LessParserTest, VariableScope) {
   ASSERT_STREQ("#page #header{color:white}#footer{color:red}", out->str().c_str());
 } 
 
+/**
+ * Nested rulesets share the lookups of their parents; a variable that a
+ * mixin returns into a scope hides the one that was found before.
+ */
+TEST_F(LessParserTest, NestedVariableScope) {
+  in->str("@a: 1; \
+@b: 2; \
+.m() { @a: 3; } \
+.x { \
+  .y { \
+    a: @a; \
+    .z { a: @a; b: @b; @b: 4; } \
+  } \
+  .w { .m(); a: @a; .v { a: @a; } } \
+}");
+  p->parseStylesheet(*less);
+  less->process(*css, context);
+  css->write(*writer);
+  ASSERT_STREQ(".x .y{a:1}.x .y .z{a:1;b:4}.x .w{a:3}.x .w .v{a:3}",
+               out->str().c_str());
+}
+
+/**
+ * The value of a variable is reused only where the variables it refers
+ * to are the same.
+ */
+TEST_F(LessParserTest, CachedVariableValue) {
+  in->str("@base: 1px; \
+@gutter: (@base * 2); \
+.a { w: @gutter; } \
+.b { @base: 5px; w: @gutter; } \
+.c { w: @gutter; } \
+.m(@base) { w: @gutter; } \
+.d { .m(3px); .m(4px); } \
+@base: 2px;");
+  p->parseStylesheet(*less);
+  less->process(*css, context);
+  css->write(*writer);
+  ASSERT_STREQ(".a{w:4px}.b{w:10px}.c{w:4px}.d{w:6px;w:8px}",
+               out->str().c_str());
+}
+
 TEST_F(LessParserTest, CssComment) {
   in->str("/* comments */");
 
@@ -894,6 +937,34 @@ TEST_F(LessParserTest, NamespaceGuardFalse) {
   EXPECT_THROW(less->process(*css, context), MixinException*);
 }
 
+TEST_F(LessParserTest, MixinSelectorParts) {
+  in->str(".a, .b { x: ab; } \
+.ab { x: ab2; } \
+#ns { > .c { x: c; } .d { x: d; } } \
+.test { .b; .ab; #ns > .c; #ns .d; }");
+
+  p->parseStylesheet(*less);
+  less->process(*css, context);
+  css->write(*writer);
+  ASSERT_STREQ(".a,.b{x:ab}.ab{x:ab2}#ns > .c{x:c}#ns .d{x:d}"
+               ".test{x:ab;x:ab2;x:c;x:d}",
+               out->str().c_str());
+}
+
+TEST_F(LessParserTest, MixinCallAfterClosure) {
+  in->str(".x() { a: outer; } \
+.m() { .x(); } \
+.t1 { .m(); } \
+.def() { .x() { a: closure; } } \
+.def(); \
+.t2 { .m(); }");
+
+  p->parseStylesheet(*less);
+  less->process(*css, context);
+  css->write(*writer);
+  ASSERT_STREQ(".t1{a:outer}.t2{a:outer;a:closure}", out->str().c_str());
+}
+
 TEST_F(LessParserTest, Default) {
   in->str(".mixin(@x) when (@x = 2) { \
   a: @x; \
@@ -928,6 +999,34 @@ TEST_F(LessParserTest, NotDefault) {
   ASSERT_STREQ(".test{a:1}", out->str().c_str());
 }
 
+TEST_F(LessParserTest, DefaultGuards) {
+  in->str(".m(@x) when (@x > 5) { a: big; } \
+.m(@x) when (@x < 0), ((default())) { a: neg-or-default; } \
+.m(@x) when (default()) { a: other; } \
+.m(@x, @y) when (default()) { a: two; } \
+.t1 { .m(10); } \
+.t2 { .m(3); } \
+.t3 { .m(-1); }");
+
+  p->parseStylesheet(*less);
+  less->process(*css, context);
+  css->write(*writer);
+  ASSERT_STREQ(".t1{a:big}.t2{a:neg-or-default;a:other}"
+               ".t3{a:neg-or-default}",
+               out->str().c_str());
+}
+
+TEST_F(LessParserTest, DefaultAndCondition) {
+  in->str(".m(@x) when (default()) and (false) { ok: 1; } \
+.m(@x) when (default()) { d: 1; } \
+.r { .m(1); }");
+
+  p->parseStylesheet(*less);
+  less->process(*css, context);
+  css->write(*writer);
+  ASSERT_STREQ(".r{d:1}", out->str().c_str());
+}
+
 TEST_F(LessParserTest, ImportantMixin) {
   in->str(".mixin(@x) { \
   x: @x; \
@@ -1096,3 +1195,31 @@ TEST_F(LessParserTest, ExtendNestedMedia) {
 {.selector{color:blue}}", out->str().c_str());
 }
 
+TEST_F(LessParserTest, ParallelParse) {
+  TokenList tokens;
+  std::vector<size_t> chunks;
+  // runs the tasks right away
+  ParallelParser parser([](const std::function<void()> &task) { task(); },
+                        1);
+
+  in->str("@c: red; \
+.m(@x) { color: @x; } \
+.@{n} { .m(@c); } \
+@n: b; \
+@media print { .d { color: @c; } } \
+@c: blue;");
+  while (t->readNextToken() != Token::EOS)
+    tokens.push_back(t->getToken());
+
+  ASSERT_TRUE(ParallelParser::split(tokens, 1, chunks));
+  ASSERT_EQ(6u, chunks.size());
+
+  ASSERT_TRUE(parser.parse(tokens, "test", *less));
+  less->process(*css, context);
+  css->write(*writer);
+  ASSERT_STREQ(".b{color:blue}@media print{.d{color:blue}}",
+               out->str().c_str());
+
+  tokens.push_back(Token("@import", Token::ATKEYWORD, 0, 0, "test"));
+  ASSERT_FALSE(ParallelParser::split(tokens, 1, chunks));
+}
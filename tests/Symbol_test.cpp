@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <less/Symbol.h>
+#include <less/SymbolTable.h>
+#include <less/VariableMap.h>
+#include <less/less/LessTokenizer.h>
+
+/**
+ * A string is interned once; looking up a string that was never
+ * interned gives the null symbol without adding it.
+ */
+TEST(SymbolTest, Intern) {
+  Symbol a("@symboltest-a"), b("@symboltest-b");
+
+  EXPECT_EQ(a, Symbol(std::string("@symboltest-a")));
+  EXPECT_NE(a, b);
+  EXPECT_NE(a.getId(), b.getId());
+  EXPECT_EQ("@symboltest-a", a.getString());
+
+  EXPECT_EQ(a, Symbol::find("@symboltest-a"));
+  EXPECT_TRUE(Symbol::find("@symboltest-c").isNull());
+  EXPECT_TRUE(Symbol::find("@symboltest-c").isNull());
+  EXPECT_EQ(0u, Symbol().getId());
+}
+
+/**
+ * The tokenizer sets the symbols of @-keywords and function names; a
+ * token that changes loses its symbol.
+ */
+TEST(SymbolTest, Token) {
+  std::string css("@symboltest-token symboltest-fn( symboltest-ident");
+  BufferInputSource in(css);
+  LessTokenizer tokenizer(in, "-");
+  Token token, copy;
+
+  ASSERT_EQ(Token::ATKEYWORD, tokenizer.readNextToken());
+  token = tokenizer.getToken();
+  EXPECT_EQ(Symbol::find("@symboltest-token"), token.getSymbol());
+  EXPECT_FALSE(token.getSymbol().isNull());
+
+  tokenizer.readNextToken();
+  ASSERT_EQ(Token::IDENTIFIER, tokenizer.readNextToken());
+  EXPECT_EQ(Symbol::find("symboltest-fn"), tokenizer.getToken().getSymbol());
+  EXPECT_FALSE(tokenizer.getToken().getSymbol().isNull());
+
+  tokenizer.readNextToken();
+  tokenizer.readNextToken();
+  ASSERT_EQ(Token::IDENTIFIER, tokenizer.readNextToken());
+  EXPECT_TRUE(tokenizer.getToken().getSymbol().isNull());
+
+  copy = token;
+  EXPECT_EQ(token.getSymbol(), copy.getSymbol());
+  copy.append('2');
+  EXPECT_TRUE(copy.getSymbol().isNull());
+  copy = token;
+  copy = std::string("@symboltest-token");
+  EXPECT_TRUE(copy.getSymbol().isNull());
+}
+
+/**
+ * Names are interned in the current table and are not found from other
+ * tables; names of the global table are found from every table.
+ */
+TEST(SymbolTest, Table) {
+  Symbol global("@symboltest-global"), a, b;
+  SymbolTable first, second;
+
+  {
+    SymbolTable::Scope scope(first);
+    a = Symbol("@symboltest-table");
+    EXPECT_EQ(global, Symbol("@symboltest-global"));
+    EXPECT_EQ(a, Symbol::find("@symboltest-table"));
+    EXPECT_EQ(1u, first.size());
+    EXPECT_EQ(&first, SymbolTable::getCurrent());
+  }
+  EXPECT_EQ(NULL, SymbolTable::getCurrent());
+  EXPECT_TRUE(Symbol::find("@symboltest-table").isNull());
+
+  {
+    SymbolTable::Scope scope(second);
+    EXPECT_TRUE(Symbol::find("@symboltest-table").isNull());
+    b = Symbol("@symboltest-table");
+    EXPECT_EQ(global, Symbol::find("@symboltest-global"));
+  }
+  EXPECT_NE(a, b);
+  EXPECT_EQ("@symboltest-table", b.getString());
+}
+
+/**
+ * Variables can be looked up by symbol or by name.
+ */
+TEST(SymbolTest, VariableMap) {
+  VariableMap variables;
+  TokenList value;
+
+  value.push_back(Token("1px", Token::DIMENSION, 0, 0, "-"));
+  variables[Symbol("@symboltest-var")] = value;
+
+  ASSERT_NE((const TokenList*)NULL, variables.getVariable("@symboltest-var"));
+  EXPECT_EQ("1px",
+            variables.getVariable(Symbol("@symboltest-var"))->toString());
+  EXPECT_EQ(NULL, variables.getVariable("@symboltest-none"));
+}
+
+/**
+ * A map keeps its variables in the order they were added, also once it
+ * is large enough to be searched through the hash table, and insert()
+ * keeps the existing value.
+ */
+TEST(SymbolTest, LargeVariableMap) {
+  VariableMap variables, copy;
+  VariableMap::const_iterator it;
+  TokenList value;
+  char name[32];
+  int i;
+
+  for (i = 0; i < 100; i++) {
+    value.clear();
+    snprintf(name, sizeof(name), "%d", i);
+    value.push_back(Token(name, Token::NUMBER, 0, 0, "-"));
+    snprintf(name, sizeof(name), "@symboltest-large-%d", i);
+    variables.insert(Symbol(name), value);
+  }
+  EXPECT_FALSE(variables.insert(Symbol("@symboltest-large-5"), value).second);
+
+  copy = variables;
+  ASSERT_EQ(100u, copy.size());
+  for (i = 0, it = copy.begin(); it != copy.end(); i++, it++) {
+    snprintf(name, sizeof(name), "@symboltest-large-%d", i);
+    EXPECT_EQ(name, it->first.getString());
+    EXPECT_EQ(it->second.toString(),
+              copy.getVariable(std::string(name))->toString());
+  }
+  EXPECT_EQ("5", copy.getVariable("@symboltest-large-5")->toString());
+  EXPECT_EQ(NULL, copy.getVariable("@symboltest-none"));
+}
@@ -49,6 +49,56 @@ TEST(ValueProcessorTest, Operators) {
   EXPECT_STREQ("2.5", l.front().c_str());
 }
 
+TEST(ValueProcessorTest, UndefinedOperation) {
+  TokenList l;
+  ValueProcessor vp;
+  ProcessingContext c;
+
+  // a keyword divided by a keyword is kept as it is
+  l.push_back(Token("center", Token::IDENTIFIER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("/", Token::OTHER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("cover", Token::IDENTIFIER, 0, 0, "-"));
+  vp.processValue(l, c);
+
+  EXPECT_EQ("center / cover", l.toString());
+
+  // also when the operation is nested
+  l.clear();
+  l.push_back(Token("1", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token("+", Token::OTHER, 0, 0, "-"));
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token("2", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token("/", Token::OTHER, 0, 0, "-"));
+  l.push_back(Token("auto", Token::IDENTIFIER, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+  vp.processValue(l, c);
+
+  EXPECT_EQ("1 + (2 / auto)", l.toString());
+}
+
+TEST(ValueProcessorTest, UndefinedCondition) {
+  TokenList l;
+  ValueProcessor vp;
+  ProcessingContext c;
+
+  // red = 1
+  l.push_back(Token("red", Token::IDENTIFIER, 3, 7, "-"));
+  l.push_back(Token("=", Token::DELIMITER, 3, 10, "-"));
+  l.push_back(Token("1", Token::NUMBER, 3, 11, "-"));
+
+  try {
+    vp.validateCondition(l, c);
+    FAIL() << "the comparison is not defined";
+  } catch (ValueException *e) {
+    EXPECT_STREQ("You can only compare a color with a *color*.", e->what());
+    EXPECT_EQ(3u, e->getLineNumber());
+    EXPECT_EQ(7u, e->getColumn());
+    delete e;
+  }
+}
+
 TEST(ValueProcessorTest, Conditions) {
   TokenList l;
   ValueProcessor vp;
@@ -93,6 +143,168 @@ TEST(ValueProcessorTest, Conditions) {
 
 }
 
+TEST(ValueProcessorTest, CompiledConditions) {
+  TokenList l;
+  ValueProcessor vp;
+  ProcessingContext c;
+
+  // (1 + 2 = 3) and true
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token("1", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("+", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("2", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token("=", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token("3", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("and", Token::IDENTIFIER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("true", Token::IDENTIFIER, 0, 0, "-"));
+
+  Condition c1(l);
+  vp.compileCondition(c1);
+  ASSERT_TRUE(c1.isCompiled());
+  EXPECT_EQ(2u, c1.getStatements().size());
+  EXPECT_TRUE(vp.validateCondition(c1, c));
+
+  // not (default())
+  l.clear();
+  l.push_back(Token("not", Token::IDENTIFIER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token("default", Token::IDENTIFIER, 0, 0, "-"));
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+
+  Condition c2(l);
+  vp.compileCondition(c2);
+  ASSERT_TRUE(c2.isCompiled());
+  EXPECT_TRUE(c2.isNegated());
+  EXPECT_TRUE(vp.validateCondition(c2, c, false));
+  EXPECT_FALSE(vp.validateCondition(c2, c, true));
+
+  // (default()) and (false)
+  l.clear();
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token("default", Token::IDENTIFIER, 0, 0, "-"));
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("and", Token::IDENTIFIER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token("false", Token::IDENTIFIER, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+
+  Condition c4(l);
+  vp.compileCondition(c4);
+  ASSERT_TRUE(c4.isCompiled());
+  EXPECT_FALSE(vp.validateCondition(c4, c, true));
+  EXPECT_FALSE(vp.validateCondition(l, c, true));
+
+  // an escaped string is evaluated from the tokens
+  l.clear();
+  l.push_back(Token("~", Token::OTHER, 0, 0, "-"));
+  l.push_back(Token("\"a\"", Token::STRING, 0, 0, "-"));
+  l.push_back(Token("=", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token("a", Token::IDENTIFIER, 0, 0, "-"));
+
+  Condition c3(l);
+  vp.compileCondition(c3);
+  EXPECT_FALSE(c3.isCompiled());
+  EXPECT_EQ(vp.validateCondition(l, c), vp.validateCondition(c3, c));
+}
+
+TEST(ValueProcessorTest, CompiledValues) {
+  TokenList l, result;
+  ValueProcessor vp;
+  ProcessingContext c;
+
+  // (1 + 2) * 3px, translate(1px)
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token("1", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("+", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("2", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+  l.push_back(Token("*", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token("3px", Token::DIMENSION, 0, 0, "-"));
+  l.push_back(Token(",", Token::OTHER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("translate", Token::IDENTIFIER, 0, 0, "-"));
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token("1px", Token::DIMENSION, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+
+  CompiledValue v1(l);
+  vp.compileValue(v1);
+  ASSERT_TRUE(v1.isCompiled());
+  EXPECT_EQ(1u, v1.getStatements().size());
+  EXPECT_EQ(5u, v1.getSegments().size());
+
+  vp.processValue(v1, result, c);
+  vp.processValue(l, c);
+  EXPECT_EQ(l.toString(), result.toString());
+  EXPECT_EQ("9px, translate(1px)", result.toString());
+
+  // a negation is evaluated from the tokens
+  l.clear();
+  l.push_back(Token("-", Token::OTHER, 0, 0, "-"));
+  l.push_back(Token("(", Token::PAREN_OPEN, 0, 0, "-"));
+  l.push_back(Token("2", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
+
+  CompiledValue v2(l);
+  vp.compileValue(v2);
+  EXPECT_FALSE(v2.isCompiled());
+
+  vp.processValue(v2, result, c);
+  vp.processValue(l, c);
+  EXPECT_EQ(l.toString(), result.toString());
+}
+
+TEST(ValueProcessorTest, StaticValues) {
+  TokenList l;
+  ValueProcessor vp;
+
+  // 960px / 12
+  l.push_back(Token("960px", Token::DIMENSION, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("/", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("12", Token::NUMBER, 0, 0, "-"));
+
+  ASSERT_TRUE(vp.isStatic(l));
+  ASSERT_TRUE(vp.processStatic(l));
+  EXPECT_EQ("80px", l.toString());
+
+  // a compiled statement without variables is evaluated once
+  l.clear();
+  l.push_back(Token("1px", Token::DIMENSION, 0, 0, "-"));
+  l.push_back(Token("+", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token("2", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token(" ", Token::WHITESPACE, 0, 0, "-"));
+  l.push_back(Token("@a", Token::ATKEYWORD, 0, 0, "-"));
+
+  EXPECT_FALSE(vp.isStatic(l));
+  CompiledValue v(l);
+  vp.compileValue(v);
+  ASSERT_TRUE(v.isCompiled());
+  ASSERT_EQ(2u, v.getSegments().size());
+  EXPECT_EQ(CompiledValue::CONSTANT, v.getSegments()[0].kind);
+  EXPECT_EQ(CompiledValue::STATEMENT, v.getSegments()[1].kind);
+
+  // interpolated strings refer to the scope
+  l.clear();
+  l.push_back(Token("\"@{a}\"", Token::STRING, 0, 0, "-"));
+  EXPECT_FALSE(vp.isStatic(l));
+}
+
 TEST(ValueProcessorTest, OperandMismatch) {
   TokenList l;
   ValueProcessor vp;
@@ -131,12 +343,44 @@ TEST(ValueProcessorTest, OperatorsInParens) {
   l.push_back(Token(")", Token::PAREN_CLOSED, 0, 0, "-"));
 
   vp.processValue(l, c);
-  
+
   ASSERT_EQ((uint)1, l.size());
   EXPECT_STREQ("5", l.front().c_str());
   ASSERT_EQ(Token::NUMBER, l.front().type);
 }
 
+TEST(ValueProcessorTest, IntermediateResults) {
+  TokenList l;
+  ValueProcessor vp;
+  ProcessingContext c;
+
+  // every result is rounded to the 10 digits it is written with
+  l.push_back(Token("1px", Token::DIMENSION, 0, 0, "-"));
+  l.push_back(Token("/", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token("3", Token::NUMBER, 0, 0, "-"));
+  l.push_back(Token("*", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token("3", Token::NUMBER, 0, 0, "-"));
+
+  vp.processValue(l, c);
+
+  ASSERT_EQ((uint)1, l.size());
+  EXPECT_STREQ("0.9999999999px", l.front().c_str());
+  ASSERT_EQ(Token::DIMENSION, l.front().type);
+
+  // a color is written once it is complete
+  l.clear();
+  l.push_back(Token("#000", Token::HASH, 0, 0, "-"));
+  l.push_back(Token("+", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token("#111", Token::HASH, 0, 0, "-"));
+  l.push_back(Token("*", Token::DELIMITER, 0, 0, "-"));
+  l.push_back(Token("2", Token::NUMBER, 0, 0, "-"));
+
+  vp.processValue(l, c);
+
+  ASSERT_EQ((uint)1, l.size());
+  EXPECT_STREQ("#222", l.front().c_str());
+}
+
 
 TEST(ValueProcessorTest, StringOperations) {
   TokenList l;